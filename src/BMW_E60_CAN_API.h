@@ -4,6 +4,7 @@
 #include <mcp_can.h>
 #include <SPI.h>
 #include <Arduino.h>
+#include "CanSignals.h"
 
 // Define CAN message IDs
 #define BMW_E60_odo_range_avFuel           0x330
@@ -51,45 +52,36 @@
 #define BMW_E60_handbrake                     0x1B4
 #define BMW_E60_AirBag                     0x2FA
 
-// ---- capture KOMBI time ----
-struct Snap { bool seen; uint8_t len; uint8_t data[8]; };
-static Snap s2F8 = {false,0,{0}};
-
-// ---- reply-wait ----
-struct ReplyWait {
-  bool active;
-  uint16_t expect[4];
-  uint8_t nExpect;
-  uint32_t deadline_ms;
-  const char* label;
-} gWait = { false, {0}, 0, 0, nullptr };
-
+// ===== Message structs (integer units; no floats on the AVR) =====
+// Each struct has a signal description (namespace E60Sig) and a generated
+// decode(buf, len, out) overload that returns false when the DLC is too short.
+// Every ID above maps to one of them; see the table after the decoders.
 
 // Define struct for Voltage_EngineState
 struct Voltage_EngineState {
-    float Voltage;
+    uint16_t Voltage_mV;
     uint16_t Engine_running_state;
 };
 
 // Define struct for Outside_Temp_and_Range
 struct Outside_Temp_and_Range {
-    uint16_t Temp;
-    uint16_t Range;
+    int16_t  Temp_dC;      // 0.1 degC
+    uint16_t Range;        // km
 };
 
 // Define struct for avSpeed_avMileage
 struct avSpeed_avMileage {
-    uint16_t avMileage;
-    uint16_t avSpeed;
+    uint16_t avMileage;    // 0.1 l/100km
+    uint16_t avSpeed;      // 0.1 km/h
     uint16_t avMileage_2;
     uint16_t avSpeed_2;
 };
 
 // Define struct for odo_range_avFuel
 struct odo_range_avFuel {
-    uint16_t ODO;
-    uint16_t AV_Fuel;
-    uint16_t Range;
+    uint32_t ODO;          // km
+    uint16_t AV_Fuel;      // litres in tank
+    uint16_t Range;        // km
 };
 
 // Define struct for Seconds_since_bat_change
@@ -133,8 +125,8 @@ struct Whiperlever {
 
 // Define struct for Engine_Temp
 struct Engine_Temp {
-    uint8_t Coolant_Temp;
-    uint8_t Oil_Temp; 
+    int16_t Coolant_Temp;  // degC
+    int16_t Oil_Temp;      // degC
 };
 
 // Define struct for PDC_Sensordata
@@ -151,10 +143,10 @@ struct PDC_Sensordata {
 
 // Define struct for WheelSpeeds
 struct WheelSpeeds {
-    float wheel01_speeds;
-    float wheel02_speeds;
-    float wheel03_speeds;
-    float wheel04_speeds;
+    uint16_t wheel01_speeds;   // 0.1 km/h
+    uint16_t wheel02_speeds;
+    uint16_t wheel03_speeds;
+    uint16_t wheel04_speeds;
 };
 
 // Define struct for Brake
@@ -166,8 +158,8 @@ struct Brake {
 
 // Define struct for Speed
 struct Speed {
-    float DSC_Speed41;
-    float DSC_Speed;
+    uint16_t DSC_Speed41;      // 0.1 km/h
+    uint16_t DSC_Speed;        // 0.1 km/h
 };
 
 // Define struct for DoorStatus
@@ -183,4 +175,385 @@ struct BootStatus {
     uint8_t Boot_Status;
 };
 
+// Define struct for KL15_STATUS (0x130)
+struct KL15_Status {
+    uint8_t Raw;           // byte 0 as sent
+    bool KlR;              // accessory
+    bool Kl15;             // ignition
+    bool Kl50;             // cranking
+};
+
+// Define struct for VIN (0x380): last seven characters, ASCII
+struct VIN_ {
+    char Last7[7];
+};
+
+// Define struct for Torque (0xA8)
+struct Torque {
+    int16_t Engine_Torque; // Nm
+};
+
+// Define struct for RPM_Throttle (0xAA)
+struct RPM_Throttle {
+    uint8_t  Pedal;        // %
+    uint16_t RPM;
+};
+
+// Define struct for SteeringWheelSensor / _2 (0xC4 / 0xC8)
+struct SteeringAngle {
+    int16_t Angle_dDeg;    // 0.1 deg, positive = left
+};
+
+// Define struct for steering_wheel_buttons (0x1D6), idle = C0 0C
+struct SteeringWheelButtons {
+    bool Vol_Up;
+    bool Vol_Down;
+    bool Next;
+    bool Prev;
+    bool Phone;
+    bool Voice;
+};
+
+// Define struct for Outside_temp (0x2CA)
+struct Outside_temp {
+    int16_t Temp_dC;       // 0.1 degC
+};
+
+// Define struct for handbrake (0x1B4): KOMBI speed and handbrake switch
+struct Handbrake {
+    uint16_t Speed;        // 0.1 km/h
+    bool     Handbrake_up;
+};
+
+// Define struct for Key_Fob_Buttons (0x23A): 1 unlock, 4 lock, 64 boot
+struct KeyFobButtons {
+    uint8_t Button;
+};
+
+// Define struct for alive-counter messages (ABS 0xC0, AirBag 0xD7)
+struct AliveCounter {
+    uint8_t Counter;
+};
+
+// Status messages whose bit meanings are not pinned down yet decode to the raw
+// first byte: seat heating, gear lever, indicator lever/status, lights, PDC
+// status, steering column adjust, dimmer, wiper status, internal temp, DSC, AirBag.
+struct StatusByte {
+    uint8_t Status;
+};
+
+// ===== Signal descriptions: Signal<start, len, order, signed, num, den, offset> =====
+namespace E60Sig {
+using CanSig::Signal;
+using CanSig::Intel;
+
+// 0x3B4 Voltage_EngineState
+typedef Signal< 0, 12, Intel, false, 250, 17>     Voltage_mV;          // 0.0147059 V/bit
+typedef Signal<16,  8>                            EngineRunningState;
+// 0x366 Outside_Temp_and_Range
+typedef Signal< 0,  8, Intel, false, 5, 1, -400>  OutsideTemp_dC;      // 0.5 degC/bit, -40 degC
+typedef Signal<12, 12>                            RangeKm_366;
+// 0x362 avSpeed_avMileage (four packed 12-bit fields)
+typedef Signal< 0, 12>                            AvMileage;
+typedef Signal<12, 12>                            AvSpeed;
+typedef Signal<24, 12>                            AvMileage2;
+typedef Signal<36, 12>                            AvSpeed2;
+// 0x330 odo_range_avFuel
+typedef Signal< 0, 24>                            OdoKm;
+typedef Signal<24,  8>                            FuelLitres;
+typedef Signal<48, 16, Intel, false, 1, 16>       RangeKm_330;         // 1/16 km/bit
+// 0x328 Seconds_since_bat_change
+typedef Signal< 0, 32>                            SecondsSinceBat;
+typedef Signal<32, 16>                            DaysSinceBat;
+// 0x2FC Door_Status
+typedef Signal< 8,  1>                            DoorDriver;
+typedef Signal<10,  1>                            DoorPassenger;
+typedef Signal<12,  1>                            DoorRearDriver;
+typedef Signal<14,  1>                            DoorRearPassenger;
+typedef Signal<16,  1>                            DoorBoot;
+typedef Signal<18,  1>                            DoorBonnet;
+// 0x2F8 DateTime
+typedef Signal< 0,  8>                            Hour;
+typedef Signal< 8,  8>                            Minute;
+typedef Signal<16,  8>                            Second;
+typedef Signal<24,  8>                            Day;
+typedef Signal<36,  4>                            Month;
+typedef Signal<40, 16>                            Year;
+// 0x2A6 Wiper lever
+typedef Signal< 0,  8>                            WiperLever;
+typedef Signal< 8,  8>                            WiperSpeed;
+// 0x1D0 Engine_Temp
+typedef Signal< 0,  8, Intel, false, 1, 1, -48>   CoolantTemp;
+typedef Signal< 8,  8, Intel, false, 1, 1, -48>   OilTemp;
+// 0x1C2 PDC_Sensordata (cm per byte)
+typedef Signal< 0,  8> PdcFLo; typedef Signal< 8,  8> PdcFLi; typedef Signal<16,  8> PdcFRi; typedef Signal<24,  8> PdcFRo;
+typedef Signal<32,  8> PdcRRo; typedef Signal<40,  8> PdcRLo; typedef Signal<48,  8> PdcRLi; typedef Signal<56,  8> PdcRRi;
+// 0xCE WheelSpeeds (1/16 km/h per bit -> 0.1 km/h)
+typedef Signal< 0, 16, Intel, false, 5, 8>        Wheel1;
+typedef Signal<16, 16, Intel, false, 5, 8>        Wheel2;
+typedef Signal<32, 16, Intel, false, 5, 8>        Wheel3;
+typedef Signal<48, 16, Intel, false, 5, 8>        Wheel4;
+// 0x19E Brake
+typedef Signal< 0,  8>                            Signal10843;
+typedef Signal<13,  1>                            BrakePressed;
+typedef Signal<48,  8>                            BrakeForce;
+// 0x1A0 Speed (0.1 km/h)
+typedef Signal< 0, 12>                            DscSpeed;
+typedef Signal<16, 12>                            DscSpeed41;
+// 0xE2/0xE6/0xEA/0xEE single door, 0xF2 boot
+typedef Signal< 0,  8>                            LockStatus;
+typedef Signal<24,  8>                            DoorState;
+typedef Signal< 8,  8>                            BootButton;
+typedef Signal<24,  8>                            BootState;
+// 0x130 KL15_STATUS
+typedef Signal< 0,  8>                            Kl15Raw;
+typedef Signal< 0,  1>                            KlR;
+typedef Signal< 2,  1>                            Kl15;
+typedef Signal< 3,  1>                            Kl50;
+// 0x380 VIN (ASCII)
+typedef Signal< 0,  8> Vin0; typedef Signal< 8,  8> Vin1; typedef Signal<16,  8> Vin2; typedef Signal<24,  8> Vin3;
+typedef Signal<32,  8> Vin4; typedef Signal<40,  8> Vin5; typedef Signal<48,  8> Vin6;
+// 0xA8 Torque (1/32 Nm per bit)
+typedef Signal< 8, 16, Intel, true, 1, 32>        EngineTorque;
+// 0xAA RPM_Throttle
+typedef Signal<24,  8, Intel, false, 100, 254>    PedalPct;
+typedef Signal<32, 16, Intel, false, 1, 4>        Rpm;                 // 0.25 rpm/bit
+// 0xC4/0xC8 steering angle (0.04395 deg/bit -> 0.1 deg)
+typedef Signal< 0, 16, Intel, true, 225, 512>     SteeringAngle_dDeg;
+// 0x1D6 steering wheel buttons
+typedef Signal< 0,  1>                            SwPhone;
+typedef Signal< 2,  1>                            SwVolDown;
+typedef Signal< 3,  1>                            SwVolUp;
+typedef Signal< 4,  1>                            SwPrev;
+typedef Signal< 5,  1>                            SwNext;
+typedef Signal< 8,  1>                            SwVoice;
+// 0x2CA Outside_temp: same encoding as 0x366 byte 0 (OutsideTemp_dC)
+// 0x1B4 handbrake (speed 1/16 km/h per bit -> 0.1 km/h)
+typedef Signal< 0, 12, Intel, false, 5, 8>        KombiSpeed;
+typedef Signal<41,  1>                            HandbrakeUp;
+// 0x23A Key_Fob_Buttons
+typedef Signal<16,  8>                            KeyButton;
+// 0xC0 / 0xD7 alive counters
+typedef Signal< 0,  8>                            AliveByte;           // ABS counts in the low nibble
+// Raw first byte of the StatusByte messages
+typedef Signal< 0,  8>                            Status0;
+} // namespace E60Sig
+
+// ===== Generated decoders =====
+#define E60_DLC(...) if (len < CanSig::minDlc<__VA_ARGS__>()) return false
+
+inline bool decode(const uint8_t* d, uint8_t len, Voltage_EngineState& o){
+  using namespace E60Sig;
+  E60_DLC(Voltage_mV, EngineRunningState);
+  o.Voltage_mV = Voltage_mV::get<uint16_t>(d);
+  o.Engine_running_state = EngineRunningState::get<uint16_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, Outside_Temp_and_Range& o){
+  using namespace E60Sig;
+  E60_DLC(OutsideTemp_dC, RangeKm_366);
+  o.Temp_dC = OutsideTemp_dC::get<int16_t>(d);
+  o.Range   = RangeKm_366::get<uint16_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, avSpeed_avMileage& o){
+  using namespace E60Sig;
+  E60_DLC(AvMileage, AvSpeed, AvMileage2, AvSpeed2);
+  o.avMileage   = AvMileage::get<uint16_t>(d);
+  o.avSpeed     = AvSpeed::get<uint16_t>(d);
+  o.avMileage_2 = AvMileage2::get<uint16_t>(d);
+  o.avSpeed_2   = AvSpeed2::get<uint16_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, odo_range_avFuel& o){
+  using namespace E60Sig;
+  E60_DLC(OdoKm, FuelLitres, RangeKm_330);
+  o.ODO     = OdoKm::get<uint32_t>(d);
+  o.AV_Fuel = FuelLitres::get<uint16_t>(d);
+  o.Range   = RangeKm_330::get<uint16_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, Seconds_since_bat_change& o){
+  using namespace E60Sig;
+  E60_DLC(SecondsSinceBat, DaysSinceBat);
+  o.Seconds_since_bat_change = SecondsSinceBat::get<uint32_t>(d);
+  o.days_since_bat_change    = DaysSinceBat::get<uint32_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, Door_Status& o){
+  using namespace E60Sig;
+  E60_DLC(DoorDriver, DoorBonnet);
+  o.Driver_Door         = DoorDriver::flag(d);
+  o.Passenger_Door      = DoorPassenger::flag(d);
+  o.rear_Driver_Door    = DoorRearDriver::flag(d);
+  o.rear_Passenger_Door = DoorRearPassenger::flag(d);
+  o.Boot                = DoorBoot::flag(d);
+  o.Bonnet              = DoorBonnet::flag(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, DateTime_& o){
+  using namespace E60Sig;
+  E60_DLC(Hour, Month, Year);
+  o.Hour   = Hour::get<uint8_t>(d);
+  o.Minute = Minute::get<uint8_t>(d);
+  o.Second = Second::get<uint8_t>(d);
+  o.Day    = Day::get<uint8_t>(d);
+  o.Month  = Month::get<uint8_t>(d);
+  o.Year   = Year::get<uint16_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, Whiperlever& o){
+  using namespace E60Sig;
+  E60_DLC(WiperLever, WiperSpeed);
+  o.Whiper_lever = WiperLever::get<uint8_t>(d);
+  o.Whiper_Speed = WiperSpeed::get<uint8_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, Engine_Temp& o){
+  using namespace E60Sig;
+  E60_DLC(CoolantTemp, OilTemp);
+  o.Coolant_Temp = CoolantTemp::get<int16_t>(d);
+  o.Oil_Temp     = OilTemp::get<int16_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, PDC_Sensordata& o){
+  using namespace E60Sig;
+  E60_DLC(PdcRRi);
+  o.Front_Left_outer  = PdcFLo::get<uint8_t>(d);  o.Front_Left_inner  = PdcFLi::get<uint8_t>(d);
+  o.Front_Right_inner = PdcFRi::get<uint8_t>(d);  o.Front_Right_outer = PdcFRo::get<uint8_t>(d);
+  o.Rear_Right_outer  = PdcRRo::get<uint8_t>(d);  o.Rear_Left_outer   = PdcRLo::get<uint8_t>(d);
+  o.Rear_Left_inner   = PdcRLi::get<uint8_t>(d);  o.Rear_Right_inner  = PdcRRi::get<uint8_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, WheelSpeeds& o){
+  using namespace E60Sig;
+  E60_DLC(Wheel1, Wheel2, Wheel3, Wheel4);
+  o.wheel01_speeds = Wheel1::get<uint16_t>(d);
+  o.wheel02_speeds = Wheel2::get<uint16_t>(d);
+  o.wheel03_speeds = Wheel3::get<uint16_t>(d);
+  o.wheel04_speeds = Wheel4::get<uint16_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, Brake& o){
+  using namespace E60Sig;
+  E60_DLC(Signal10843, BrakePressed, BrakeForce);
+  o.SIGNAL10843  = Signal10843::get<uint8_t>(d);
+  o.BrakePressed = BrakePressed::get<uint8_t>(d);
+  o.Brake_force  = BrakeForce::get<uint8_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, Speed& o){
+  using namespace E60Sig;
+  E60_DLC(DscSpeed, DscSpeed41);
+  o.DSC_Speed   = DscSpeed::get<uint16_t>(d);
+  o.DSC_Speed41 = DscSpeed41::get<uint16_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, DoorStatus& o){
+  using namespace E60Sig;
+  E60_DLC(LockStatus, DoorState);
+  o.lockStatus = LockStatus::get<uint8_t>(d);
+  o.doorStatus = DoorState::get<uint8_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, BootStatus& o){
+  using namespace E60Sig;
+  E60_DLC(LockStatus, BootButton, BootState);
+  o.lockStatus  = LockStatus::get<uint8_t>(d);
+  o.Boot_button = BootButton::get<uint8_t>(d);
+  o.Boot_Status = BootState::get<uint8_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, KL15_Status& o){
+  using namespace E60Sig;
+  E60_DLC(Kl15Raw);
+  o.Raw  = Kl15Raw::get<uint8_t>(d);
+  o.KlR  = KlR::flag(d);
+  o.Kl15 = Kl15::flag(d);
+  o.Kl50 = Kl50::flag(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, VIN_& o){
+  using namespace E60Sig;
+  E60_DLC(Vin6);
+  o.Last7[0] = Vin0::get<char>(d); o.Last7[1] = Vin1::get<char>(d); o.Last7[2] = Vin2::get<char>(d);
+  o.Last7[3] = Vin3::get<char>(d); o.Last7[4] = Vin4::get<char>(d); o.Last7[5] = Vin5::get<char>(d);
+  o.Last7[6] = Vin6::get<char>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, Torque& o){
+  using namespace E60Sig;
+  E60_DLC(EngineTorque);
+  o.Engine_Torque = EngineTorque::get<int16_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, RPM_Throttle& o){
+  using namespace E60Sig;
+  E60_DLC(PedalPct, Rpm);
+  o.Pedal = PedalPct::get<uint8_t>(d);
+  o.RPM   = Rpm::get<uint16_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, SteeringAngle& o){
+  using namespace E60Sig;
+  E60_DLC(SteeringAngle_dDeg);
+  o.Angle_dDeg = SteeringAngle_dDeg::get<int16_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, SteeringWheelButtons& o){
+  using namespace E60Sig;
+  E60_DLC(SwPhone, SwVoice);
+  o.Vol_Up   = SwVolUp::flag(d);
+  o.Vol_Down = SwVolDown::flag(d);
+  o.Next     = SwNext::flag(d);
+  o.Prev     = SwPrev::flag(d);
+  o.Phone    = SwPhone::flag(d);
+  o.Voice    = SwVoice::flag(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, Outside_temp& o){
+  using namespace E60Sig;
+  E60_DLC(OutsideTemp_dC);
+  o.Temp_dC = OutsideTemp_dC::get<int16_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, Handbrake& o){
+  using namespace E60Sig;
+  E60_DLC(KombiSpeed, HandbrakeUp);
+  o.Speed        = KombiSpeed::get<uint16_t>(d);
+  o.Handbrake_up = HandbrakeUp::flag(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, KeyFobButtons& o){
+  using namespace E60Sig;
+  E60_DLC(KeyButton);
+  o.Button = KeyButton::get<uint8_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, AliveCounter& o){
+  using namespace E60Sig;
+  E60_DLC(AliveByte);
+  o.Counter = AliveByte::get<uint8_t>(d);
+  return true;
+}
+inline bool decode(const uint8_t* d, uint8_t len, StatusByte& o){
+  using namespace E60Sig;
+  E60_DLC(Status0);
+  o.Status = Status0::get<uint8_t>(d);
+  return true;
+}
+#undef E60_DLC
+
+// ===== ID -> struct =====
+//   0x3B4 Voltage_EngineState   0x366 Outside_Temp_and_Range  0x362 avSpeed_avMileage
+//   0x330 odo_range_avFuel      0x328 Seconds_since_bat_change 0x2FC Door_Status
+//   0x2F8 DateTime_             0x2A6 Whiperlever             0x1D0 Engine_Temp
+//   0x1C2 PDC_Sensordata        0xCE  WheelSpeeds             0x19E Brake
+//   0x1A0 Speed                 0xE2/0xE6/0xEA/0xEE DoorStatus 0xF2 BootStatus
+//   0x130 KL15_Status           0x380 VIN_                    0xA8  Torque
+//   0xAA  RPM_Throttle          0xC4/0xC8 SteeringAngle       0x1D6 SteeringWheelButtons
+//   0x2CA Outside_temp          0x1B4 Handbrake               0x23A KeyFobButtons
+//   0xC0/0xD7 AliveCounter
+//   StatusByte: 0x1E7 0x1E8 0x304 0x1EE 0x1F6 0x2F6 0x24A 0x1EA 0x202 0x252 0x32E 0x336 0x2FA
+
 #endif  // BMW_E60_CAN_API_H
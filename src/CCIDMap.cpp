@@ -0,0 +1,197 @@
+#include "CCIDMap.h"
+
+namespace Ccid {
+
+// Sorted by CC-ID (checked below). Track names from the map in CCIDMap.h; the attr column is the
+// Filter class (A1 stop-now, A2 drive-now, A3 high severity, NOTIF = A4 + B) plus mirror flags.
+static constexpr Entry kTable[] PROGMEM = {
+  {    0, 23, NOTIF          },   // all system ok
+  {   13, 21, NOTIF          },   // dont forget key
+  {   14, 11, A2             },   // passager door
+  {   15, 12, A2             },   // driver door
+  {   16,  3, A2             },   // rear left door
+  {   17,  4, A2             },   // rear right door
+  {   18, 10, A2             },   // hood open
+  {   19,  9, A2             },   // trunk open
+  {   25,  8, NOTIF          },   // preheating wait
+  {   27, 31, NOTIF          },   // low oil level
+  {   28, 31, NOTIF          },   // low oil level
+  {   29, 32, A3             },   // motor power reduced
+  {   30, 33, A1             },   // motor fault stop directly
+  {   31, 32, A3             },   // motor power reduced
+  {   32,  7, NOTIF          },   // fill cap open
+  {   33, 33, A1             },   // motor fault stop directly
+  {   35, 42, A3             },   // traction control fault
+  {   36, 41, NOTIF          },   // traction mode deactivated
+  {   38,  6, NOTIF          },   // key not found
+  {   39, 33, A1             },   // motor fault stop directly
+  {   46,  2, A2|SEATBELT    },   // seatbelt warning
+  {   49, 32, A3             },   // motor power reduced
+  {   55,  5, NOTIF          },   // parking brake not down
+  {   63, 37, A3             },   // air leak on one of tyres
+  {   66,  6, NOTIF          },   // key not found
+  {   67, 51, NOTIF          },   // key battery low
+  {   71, 38, NOTIF          },   // brake pads worn
+  {   74, 39, A1             },   // low brake fluid
+  {   79, 43, NOTIF          },   // ice roads
+  {   87, 24, NOTIF          },   // bulb burned out
+  {   88, 24, NOTIF          },   // bulb burned out
+  {   89, 24, NOTIF          },   // bulb burned out
+  {   91,  2, A2|SEATBELT    },   // seatbelt warning
+  {  111, 24, NOTIF          },   // bulb burned out
+  {  113, 16, NOTIF          },   // Side lights
+  {  114, 24, NOTIF          },   // bulb burned out
+  {  115, 24, NOTIF          },   // bulb burned out
+  {  116, 24, NOTIF          },   // bulb burned out
+  {  117, 24, NOTIF          },   // bulb burned out
+  {  118, 24, NOTIF          },   // bulb burned out
+  {  119, 24, NOTIF          },   // bulb burned out
+  {  120, 24, NOTIF          },   // bulb burned out
+  {  121, 24, NOTIF          },   // bulb burned out
+  {  122, 24, NOTIF          },   // bulb burned out
+  {  123, 24, NOTIF          },   // bulb burned out
+  {  124, 24, NOTIF          },   // bulb burned out
+  {  125, 24, NOTIF          },   // bulb burned out
+  {  126, 24, NOTIF          },   // bulb burned out
+  {  127, 24, NOTIF          },   // bulb burned out
+  {  128, 24, NOTIF          },   // bulb burned out
+  {  129, 24, NOTIF          },   // bulb burned out
+  {  130, 24, NOTIF          },   // bulb burned out
+  {  131, 24, NOTIF          },   // bulb burned out
+  {  132, 24, NOTIF          },   // bulb burned out
+  {  133, 24, NOTIF          },   // bulb burned out
+  {  134, 24, NOTIF          },   // bulb burned out
+  {  135, 24, NOTIF          },   // bulb burned out
+  {  136, 24, NOTIF          },   // bulb burned out
+  {  137, 24, NOTIF          },   // bulb burned out
+  {  138, 24, NOTIF          },   // bulb burned out
+  {  139, 25, A3             },   // tyre front left
+  {  140, 27, A3             },   // tyre rear right
+  {  141, 28, A3             },   // tyre rear left
+  {  142, 29, A3             },   // tyre pressure not same
+  {  143, 26, A3             },   // tyre front right
+  {  164, 18, NOTIF          },   // low washer liquid
+  {  165, 43, NOTIF          },   // ice roads
+  {  166, 17, A3             },   // coolant low
+  {  167, 20, NOTIF          },   // SET TIME
+  {  182, 34, NOTIF          },   // oil level sensor fault
+  {  184, 40, NOTIF          },   // traction mode active
+  {  196, 24, NOTIF          },   // bulb burned out
+  {  197, 24, NOTIF          },   // bulb burned out
+  {  205,  6, NOTIF          },   // key not found
+  {  212, 33, A1             },   // motor fault stop directly
+  {  213, 35, A3             },   // alternator fault
+  {  216, 32, A3             },   // motor power reduced
+  {  220, 22, A3|BATT_LOW    },   // battery low
+  {  229, 22, A3|BATT_LOW    },   // battery low
+  {  236, 42, A3             },   // traction control fault
+  {  237, 42, A3             },   // traction control fault
+  {  257, 36, A1             },   // engine overheating
+  {  265, 30, A3             },   // tyre overfilled
+  {  275, 19, NOTIF|LOW_FUEL },   // LOW FUEL
+  {  281, 44, NOTIF          },   // maintenance required
+  {  284, 44, NOTIF          },   // maintenance required
+  {  286, 19, NOTIF|LOW_FUEL },   // LOW FUEL
+  {  304, 22, A3|BATT_LOW    },   // battery low
+  {  306, 22, A3|BATT_LOW    },   // battery low
+  {  345, 24, NOTIF          },   // bulb burned out
+  {  346, 24, NOTIF          },   // bulb burned out
+  {  367, 36, A1             },   // engine overheating
+  {  371, 24, NOTIF          },   // bulb burned out
+  {  372, 24, NOTIF          },   // bulb burned out
+  {  373, 24, NOTIF          },   // bulb burned out
+  {  378, 24, NOTIF          },   // bulb burned out
+  {  379, 24, NOTIF          },   // bulb burned out
+  {  380, 24, NOTIF          },   // bulb burned out
+  {  381, 24, NOTIF          },   // bulb burned out
+  {  382, 42, A3             },   // traction control fault
+  {  384, 37, A3             },   // air leak on one of tyres
+  {  389,  2, A2|SEATBELT    },   // seatbelt warning
+  {  390,  2, A2|SEATBELT    },   // seatbelt warning
+  {  415, 22, A3|BATT_LOW    },   // battery low
+  {  427, 33, A1             },   // motor fault stop directly
+  {  568, 33, A1             },   // motor fault stop directly
+  {  608, 25, A3             },   // tyre front left
+  {  609, 26, A3             },   // tyre front right
+  {  610, 27, A3             },   // tyre rear right
+  {  611, 28, A3             },   // tyre rear left
+  {  961, 33, A1             },   // motor fault stop directly
+  { 1001, 45, NOTIF          },   // dont forget to fill up (synthetic)
+  { 1002, 46, NOTIF          },   // goodbye driver (synthetic)
+  { 1003, 47, NOTIF          },   // goodbye driver 2 (synthetic)
+  { 1004, 48, NOTIF          },   // goodbye driver and passager (synthetic)
+  { 1005, 49, NOTIF          },   // goodbye driver and passager 2 (synthetic)
+  { 1006, 50, NOTIF          },   // handbrake not up (synthetic)
+};
+static const uint8_t COUNT = sizeof(kTable) / sizeof(kTable[0]);
+
+constexpr bool sortedFrom(uint8_t i) {
+  return i + 1 >= COUNT || (kTable[i].ccid < kTable[i + 1].ccid && sortedFrom((uint8_t)(i + 1)));
+}
+static_assert(COUNT <= MAX_ROWS, "Ccid: table outgrew MAX_ROWS (ActiveSet bitmap)");
+static_assert(sortedFrom(0), "Ccid: kTable must be strictly ascending by CC-ID");
+
+Info lookup(uint16_t ccid) {
+  uint8_t lo = 0, hi = COUNT;
+  while (lo < hi) {
+    const uint8_t  mid = (uint8_t)((lo + hi) >> 1);
+    const uint16_t c   = pgm_read_word(&kTable[mid].ccid);
+    if (c == ccid) {
+      Info in;
+      in.track = pgm_read_byte(&kTable[mid].track);
+      in.attr  = pgm_read_byte(&kTable[mid].attr);
+      in.row   = mid;
+      return in;
+    }
+    if (c < ccid) lo = (uint8_t)(mid + 1); else hi = mid;
+  }
+  Info in; in.track = DEFAULT_TRACK; in.attr = NOTIF; in.row = NO_ROW;
+  return in;
+}
+
+uint8_t count() { return COUNT; }
+
+// --- ActiveSet ---
+bool ActiveSet::set(uint16_t ccid, const Info& in) {
+  if (in.row != NO_ROW) {
+    uint8_t& b = _bits[in.row >> 3];
+    const uint8_t m = (uint8_t)(1u << (in.row & 7));
+    if (b & m) return false;
+    b |= m;
+  } else {
+    for (uint8_t i = 0; i < _nOther; i++) if (_other[i] == ccid) return false;
+    if (_nOther == OTHER_CAP) {           // cannot remember it: announce every time, as before
+      if (_dropped < 255) _dropped++;
+      return true;
+    }
+    _other[_nOther++] = ccid;
+  }
+  _n[in.prio()]++;
+  if (in.is(SEATBELT)) _belts++;
+  return true;
+}
+
+bool ActiveSet::clear(uint16_t ccid, const Info& in) {
+  if (in.row != NO_ROW) {
+    uint8_t& b = _bits[in.row >> 3];
+    const uint8_t m = (uint8_t)(1u << (in.row & 7));
+    if (!(b & m)) return false;
+    b &= (uint8_t)~m;
+  } else {
+    uint8_t i = 0;
+    while (i < _nOther && _other[i] != ccid) i++;
+    if (i == _nOther) return false;
+    _other[i] = _other[--_nOther];
+  }
+  _n[in.prio()]--;
+  if (in.is(SEATBELT)) _belts--;
+  return true;
+}
+
+void ActiveSet::reset() {
+  memset(_bits, 0, sizeof(_bits));
+  memset(_n, 0, sizeof(_n));
+  _nOther = 0; _belts = 0;
+}
+
+} // namespace Ccid
@@ -3,7 +3,7 @@
 
 // NOTE: keep as-is unless you explicitly raise it elsewhere.
 // Tracks 51–53 exist in your list; ensure DF_MAX_MP3 is large enough
-// in your build if you want to play them via Player::playTrack().
+// in your build if you want to play them via Player::requestPlay().
 #define  DF_MAX_MP3  60 // max sounds
 
 /*
@@ -64,110 +64,67 @@
   0053 sport mode off (tied to CAN button press later)
 */
 
-inline uint16_t trackForCcid(uint16_t id) {
-  switch (id) {
-    case 0:   return 23; // all system ok
-
-    // Seatbelt
-    case 46: case 91: case 389: case 390: return 2;
-
-    // Doors / trunk / hood
-    case 16:  return 3;   // rear left
-    case 17:  return 4;   // rear right
-    case 19:  return 9;   // trunk
-    case 18:  return 10;  // hood
-    case 14:  return 11;  // passenger door
-    case 15:  return 12;  // driver door
-
-    // Parking brake & key
-    case 55:  return 5;   // parking brake not down
-    case 38: case 205: case 66: return 6; // key not found
-    case 13:  return 21;  // don't forget key
-
-    // Caps / preheat / lights
-    case 32:  return 7;   // fill cap open
-    case 25:  return 8;   // preheating wait
-    case 113: return 16;  // side lights
-
-    // Fluids & coolant & fuel
-    case 166: return 17;                // coolant low
-    case 164: return 18;                // low washer liquid
-    case 275: case 286: return 19;      // low fuel
-    case 167: return 20;                // set time
-
-    // Battery low (added 415)
-    case 306: case 304: case 229: case 220: case 415: return 22;
-
-    // Bulbs out
-    case 87: case 88: case 89: case 111: case 114: case 115: case 116: case 117: case 118:
-    case 119: case 120: case 121: case 122: case 123: case 124: case 125: case 126: case 127:
-    case 128: case 129: case 130: case 131: case 132: case 133: case 134: case 135: case 136:
-    case 137: case 138: case 196: case 197: case 345: case 346: case 371: case 372: case 373:
-    case 378: case 379: case 380: case 381: return 24;
-
-    // Tyres
-    case 139: case 608: return 25;   // front left
-    case 143: case 609: return 26;   // front right
-    case 140: case 610: return 27;   // rear right
-    case 141: case 611: return 28;   // rear left
-    case 142: return 29;             // pressure not same
-    case 265: return 30;             // overfilled
-    case 63: case 384: return 37;    // air leak
-
-    // Oil / power / faults
-    case 27: case 28: return 31;                                   // low oil level
-    case 29: case 31: case 49: case 216: return 32;                // motor power reduced
-    case 30: case 33: case 39: case 212: case 427: case 961: case 568: return 33; // motor fault stop
-    case 182: return 34;                                           // oil level sensor fault
-    case 213: return 35;                                           // alternator fault
-    case 257: case 367: return 36;                                 // engine overheating
-
-    // Brakes, traction, road/maintenance
-    case 71:  return 38;                     // brake pads worn
-    case 74:  return 39;                     // low brake fluid
-    case 184: return 40;                     // traction mode active
-    case 36:  return 41;                     // traction mode deactivated
-    case 35: case 236: case 237: case 382: return 42; // traction control fault
-    case 79: case 165: return 43;            // ice roads
-    case 281: case 284: return 44;           // maintenance required
-
-    // Key battery low
-    case 67:  return 51;
-
-    // Custom/synthetic IDs (optional; keep if used elsewhere)
-    case 1001: return 45; // don't forget to fill up (reminder)
-    case 1002: return 46; // goodbye driver
-    case 1003: return 47; // goodbye driver 2
-    case 1004: return 48; // goodbye driver & passenger
-    case 1005: return 49; // goodbye driver & passenger 2
-    case 1006: return 50; // handbrake not up
-
-    default: return 14;   // generic warning gong
-  }
-}
-
-// Helpers stay the same, with 415 included in battery-low set.
-inline bool isSeatbeltCCID(uint16_t id){
-  return (id==46 || id==91 || id==389 || id==390);
-}
-
-inline bool isBatteryLowCCID(uint16_t id){
-  return (id==306 || id==304 || id==229 || id==220 || id==415);
-}
-
-inline bool isLowFuelCCID(uint16_t id){
-  return (id==275 || id==286);
-}
+// ===== CC-ID table (CCIDMap.cpp) =====
+// Every known CC-ID is one sorted PROGMEM row {ccid, track, attr}; a binary search returns the
+// track, the Filter class and the flags in one pass. IDs not in the table: generic gong, notification.
+namespace Ccid {
+
+enum : uint8_t {
+  NOTIF = 0, A3 = 1, A2 = 2, A1 = 3,      // attr bits 0..1 = priority (== PlayIntent::prio)
+  PRIO_MASK = 0x03,
+  SEATBELT  = 0x04,
+  LOW_FUEL  = 0x08,
+  BATT_LOW  = 0x10,
+};
+static const uint8_t DEFAULT_TRACK = 14;  // generic warning gong
+static const uint8_t MAX_ROWS = 128;      // table capacity (ActiveSet bitmap size)
+static const uint8_t NO_ROW   = 0xFF;     // Info::row for IDs not in the table
+
+struct Entry { uint16_t ccid; uint8_t track; uint8_t attr; };
+struct Info {
+  uint8_t track, attr, row;
+  uint8_t prio() const { return attr & PRIO_MASK; }
+  bool    is(uint8_t flag) const { return (attr & flag) != 0; }
+};
+
+Info lookup(uint16_t ccid);
+uint8_t count();                          // rows in the table
+
+// ===== Active CC-ID set =====
+// One bit per table row (16 B) instead of one per ID, plus a few slots for IDs the table does not
+// know. Counts per class and for seatbelt IDs are kept on every edge, so "anything active?" and
+// "how many A1?" cost nothing. set()/clear() return true only on a real change.
+class ActiveSet {
+public:
+  bool set(uint16_t ccid, const Info& in);
+  bool clear(uint16_t ccid, const Info& in);
+  void reset();
+
+  uint8_t count() const { return (uint8_t)(_n[0] + _n[1] + _n[2] + _n[3]); }
+  uint8_t count(uint8_t prio) const { return _n[prio & PRIO_MASK]; }
+  uint8_t seatbelts() const { return _belts; }
+  uint8_t untracked() const { return _dropped; }   // unknown IDs seen with all slots taken
+
+private:
+  static const uint8_t OTHER_CAP = 6;
+  uint8_t  _bits[MAX_ROWS / 8] = {};
+  uint16_t _other[OTHER_CAP];
+  uint8_t  _nOther = 0;
+  uint8_t  _n[4] = {};                    // by prio
+  uint8_t  _belts = 0;
+  uint8_t  _dropped = 0;
+};
+
+} // namespace Ccid
+
+inline uint16_t trackForCcid(uint16_t id) { return Ccid::lookup(id).track; }
+
+inline bool isSeatbeltCCID(uint16_t id)   { return Ccid::lookup(id).is(Ccid::SEATBELT); }
+inline bool isBatteryLowCCID(uint16_t id) { return Ccid::lookup(id).is(Ccid::BATT_LOW); }
+inline bool isLowFuelCCID(uint16_t id)    { return Ccid::lookup(id).is(Ccid::LOW_FUEL); }
 
 // Returns true if the given CC-ID is a "battery low" warning
-inline bool isLowBatteryCCID(uint16_t ccid) {
-  switch (ccid) {
-    case 306: case 304: case 229: case 220: case 415:
-      return true;
-    default:
-      return false;
-  }
-}
+inline bool isLowBatteryCCID(uint16_t ccid) { return isBatteryLowCCID(ccid); }
 
 // ccidStatus: 0x02 = Active, 0x01 = Cleared
 static inline bool isLowBatteryActive(uint16_t ccid, uint8_t ccidStatus) {
@@ -1,77 +1,316 @@
 #include "CanBus.h"
+#include "CanFilterPlan.h"
+#include "BMW_E60_CAN_API.h"   // E60Sig signal descriptions
+
+CanBus* CanBus::_isrSelf = nullptr;
 
 CanBus::CanBus(uint8_t csPin)
-: _can(csPin), _histHead(0), _historyDepth(10), _dedupWindowMs(300) {
-  for(uint8_t i=0;i<MAX_HISTORY;i++) _hist[i].valid=false;
+: _can(csPin), _csPin(csPin), _dedupWindowMs(300) {
+  for(uint8_t i=0;i<CanIds::COUNT;i++) _dedup[i].len=0xFF;
+  resetStats();
 }
 
 bool CanBus::begin() {
-  pinMode(PIN_CAN_CS, OUTPUT);
-  digitalWrite(PIN_CAN_CS, HIGH);
+  pinMode(_csPin, OUTPUT);
+  digitalWrite(_csPin, HIGH);
   SPI.begin();
 
-if (_can.begin(MCP_ANY, CAN_100KBPS, MCP_8MHZ) != CAN_OK)
-  return false;
-
-// Filters: CCID, KEYBTN, DOORS2, KL15, HANDBRAKE, AIRBAG, BUTTON
-_can.init_Mask(0, 0, 0x7FF);           // Full 11-bit mask (standard frames)
-_can.init_Filt(0, 0, ID_CCID);
-_can.init_Filt(1, 0, ID_KEYBTN);
+  // MCP_STDEXT: masks/filters active (MCP_ANY would switch them off)
+  if (_can.begin(MCP_STDEXT, CAN_100KBPS, MCP_8MHZ) != CAN_OK)
+    return false;
 
-_can.init_Mask(1, 0, 0x7FF);
-_can.init_Filt(2, 0, ID_DOORS2);
-_can.init_Filt(3, 0, ID_KL15);
-_can.init_Filt(4, 0, ID_HANDBRAKE);
-_can.init_Filt(5, 0, ID_BUTTON);      
-  
+  // Masks/filters come from the compile-time plan (CanFilterPlan.h): every subscribed ID passes,
+  // CC-ID/key-fob land in the high-priority RXB0.
+  // Words are pre-encoded for mcp_can (SID in bits 16..26, see CanFilterPlan::libWord).
+  for(uint8_t m=0;m<2;m++) _can.init_Mask(m, 0, pgm_read_dword(&CanFilterPlan::kMask[m]));
+  for(uint8_t f=0;f<6;f++) _can.init_Filt(f, 0, pgm_read_dword(&CanFilterPlan::kFilt[f]));
 
   _can.setMode(MCP_NORMAL);
+  mcpBitMod(MCP_CANINTF, MCP_TX0IF | MCP_TX1IF | MCP_TX2IF, 0);   // TX flags are polled, never IRQ-enabled
   pinMode(PIN_CAN_INT, INPUT);
 
+  if(_rxMode == RxMode::Interrupt){
+    _intPort = portInputRegister(digitalPinToPort(PIN_CAN_INT));
+    _intMask = digitalPinToBitMask(PIN_CAN_INT);
+    _isrSelf = this;
+    SPI.usingInterrupt(255);   // main-context SPI transactions run with IRQs masked
+#if !CAN_RX_USE_PCINT
+    OCR0B = 0x80;              // mid-period of the millis() overflow tick
+#endif
+    rxIrqEnable(true);
+  }
+
   return true;
 }
 
+// ================= ISR-fed RX ring =================
+#if CAN_RX_USE_PCINT
+ISR(PCINT0_vect){ CanBus::isrService(); }          // D8 = PCINT0 (port B group)
+#else
+ISR(TIMER0_COMPB_vect){ CanBus::isrService(); }
+#endif
+
+void CanBus::isrService(){ if(_isrSelf) _isrSelf->drainRx(); }
+
+void CanBus::rxIrqEnable(bool on){
+#if CAN_RX_USE_PCINT
+  if(on){ *digitalPinToPCMSK(PIN_CAN_INT) |=  _BV(digitalPinToPCMSKbit(PIN_CAN_INT));
+          *digitalPinToPCICR(PIN_CAN_INT) |=  _BV(digitalPinToPCICRbit(PIN_CAN_INT)); }
+  else      *digitalPinToPCMSK(PIN_CAN_INT) &= ~_BV(digitalPinToPCMSKbit(PIN_CAN_INT));
+#else
+  if(on) TIMSK0 |= _BV(OCIE0B); else TIMSK0 &= ~_BV(OCIE0B);
+#endif
+  if(on){ uint8_t sreg = SREG; cli(); drainRx(); SREG = sreg; }  // INT may already be low (no edge)
+}
+
+// INT stays LOW while RXB0/RXB1 hold a frame; drain until it releases. No frame cap: PCINT is
+// edge-triggered, so leaving with INT still LOW would leave no edge to ever call us again.
+// A read that finds nothing while INT is LOW (SPI glitch) is retried; RX_READ_FAILS in a row
+// give up and leave the rest to rxWatchdog().
+void CanBus::drainRx(){
+  if(!_intPort) return;
+  const uint32_t now = millis();
+  uint8_t fails = 0;
+  while(!(*_intPort & _intMask)){
+    unsigned long id; uint8_t len; uint8_t data[8];
+    if(_can.readMsgBuf(&id, &len, data) != CAN_OK){
+      if(++fails >= RX_READ_FAILS) break;
+      continue;
+    }
+    fails = 0;
+    const uint8_t h = _rxHead, n = (uint8_t)((h + 1u) & (RX_RING_CAP - 1u));
+    if(n == _rxTail){ _rxOverflow++; continue; }   // full: drop newest, keep HW buffer draining
+    RxFrame &f = _rxRing[h];
+    f.id = (uint16_t)id; f.len = (len > 8) ? 8 : len; f.t = now; f.us16 = (uint16_t)micros();
+    for(uint8_t i=0;i<f.len;i++) f.data[i]=data[i];
+    _rxHead = n;
+  }
+}
+
+// Main-loop backstop for the edge-triggered source: INT LOW with nothing in the ring means the
+// ISR is not going to run again on its own (missed edge or a drain that gave up).
+void CanBus::rxWatchdog(){
+  if(_rxMode != RxMode::Interrupt || !_intPort) return;
+  if(*_intPort & _intMask) return;
+  if(_rxTail != _rxHead) return;                   // frames pending: INT may just be the next one
+  uint8_t sreg = SREG; cli();
+  drainRx();
+  SREG = sreg;
+  _busStats.rxKicks++;
+}
+
+uint16_t CanBus::rxOverflows() const {
+  uint8_t sreg = SREG; cli(); uint16_t n = _rxOverflow; SREG = sreg;
+  return n;
+}
+
 
 // ================= raw + de-dup =================
-bool CanBus::readRaw(uint32_t &id, uint8_t &len, uint8_t *buf){
+bool CanBus::readRaw(uint32_t &id, uint8_t &len, uint8_t *buf, uint32_t &t, uint32_t &us){
+  if(_rxMode == RxMode::Interrupt){
+    const uint8_t r = _rxTail;
+    if(r == _rxHead) return false;
+    const RxFrame &f = _rxRing[r];
+    id=f.id; len=f.len; t=f.t; for(uint8_t i=0;i<f.len;i++) buf[i]=f.data[i];
+    // Full RX micros(): coarse age from the ms stamp, exact low bits from us16 (any ring age)
+    const uint32_t approx = micros() - (millis() - f.t) * 1000UL;
+    us = approx + (uint32_t)(int32_t)(int16_t)(f.us16 - (uint16_t)approx);
+    _rxTail = (uint8_t)((r + 1u) & (RX_RING_CAP - 1u));
+    return true;
+  }
   if(_can.checkReceive() != CAN_MSGAVAIL) return false;
   unsigned long _id; uint8_t _len; uint8_t _buf[8];
   if(_can.readMsgBuf(&_id, &_len, _buf) != CAN_OK) return false;
-  id=_id; len=_len; for(uint8_t i=0;i<_len && i<8;i++) buf[i]=_buf[i];
+  id=_id; len=(_len>8)?8:_len; for(uint8_t i=0;i<len;i++) buf[i]=_buf[i];
+  t=millis(); us=micros();
   return true;
 }
-bool CanBus::isDuplicate(uint32_t id, uint8_t len, const uint8_t *buf, uint32_t now) const{
-  const uint16_t win=_dedupWindowMs; const uint8_t depth=_historyDepth;
-  for(uint8_t i=0;i<depth && i<MAX_HISTORY;i++){
-    const FrameRec&r=_hist[i]; if(!r.valid) continue;
-    if((uint32_t)(now - r.t) > win) continue;
-    if(r.id!=id || r.len!=len) continue;
-    bool same=true; for(uint8_t b=0;b<len;b++){ if(r.data[b]!=buf[b]){ same=false; break; } }
-    if(same) return true;
-  }
-  return false;
-}
-void CanBus::pushHistory(uint32_t id, uint8_t len, const uint8_t *buf, uint32_t now){
-  FrameRec&r=_hist[_histHead];
-  r.id=id; r.len=len; r.t=now; r.valid=true;
+bool CanBus::isDuplicate(uint32_t id, uint8_t len, const uint8_t *buf, uint32_t now){
+  const uint8_t slot=CanIds::slotOf(id);
+  if(slot==CanIds::NO_SLOT) return false;          // not subscribed: nothing to compare against
+  DedupSlot&r=_dedup[slot];
+  if(r.len==len && (uint32_t)(now - r.t) <= _dedupWindowMs && memcmp(r.data, buf, len)==0) return true;
+  r.t=now; r.len=len;
   for(uint8_t i=0;i<len && i<8;i++) r.data[i]=buf[i];
-  _histHead++; if(_histHead>=MAX_HISTORY) _histHead=0;
+  return false;
 }
 bool CanBus::readOnceDistinct(uint32_t &id, uint8_t &len, uint8_t *buf){
   uint8_t pulls=0;
   while(pulls<6){
-    if(!readRaw(id,len,buf)) return false;
+    uint32_t now, rxUs;
+    if(!readRaw(id,len,buf,now,rxUs)) return false;
     pulls++;
-    uint32_t now=millis();
+    const uint8_t slot=CanIds::slotOf(id);
+    if(slot==CanIds::NO_SLOT){ _busStats.unsubscribed++; return true; }
+    noteRx(slot, now);
     if(!isDuplicate(id,len,buf,now)){
-      pushHistory(id,len,buf,now);
+      LatTrace::frame(rxUs);
+      LatTrace::frameStage(LatTrace::ACCEPT);
       return true;
     }
+    _idStats[slot].dup++;
   }
   return false;
 }
 
-// ================= KOMBI sweep (unchanged) =================
+// ================= MCP2515 TX buffers =================
+// Each helper is one SPI transaction; SPI.usingInterrupt() makes it atomic against the RX ISR,
+// and nothing here touches MCP_CAN's message scratch, so RX keeps draining while frames queue.
+static const SPISettings MCP_SPI(10000000, MSBFIRST, SPI_MODE0);   // same as MCP_CAN
+static inline uint8_t txbCtrl(uint8_t b){ return (uint8_t)(MCP_TXB0CTRL + 0x10 * b); }
+
+void CanBus::mcpSelect(){ SPI.beginTransaction(MCP_SPI); digitalWrite(_csPin, LOW); }
+void CanBus::mcpDeselect(){ digitalWrite(_csPin, HIGH); SPI.endTransaction(); }
+uint8_t CanBus::mcpRead(uint8_t addr){
+  mcpSelect(); SPI.transfer(MCP_READ); SPI.transfer(addr); const uint8_t v = SPI.transfer(0); mcpDeselect();
+  return v;
+}
+uint8_t CanBus::mcpReadStatus(){   // b2/b4/b6 = TXREQ0..2, b3/b5/b7 = TX0IF..TX2IF
+  mcpSelect(); SPI.transfer(MCP_READ_STATUS); const uint8_t v = SPI.transfer(0); mcpDeselect();
+  return v;
+}
+void CanBus::mcpBitMod(uint8_t addr, uint8_t mask, uint8_t val){
+  mcpSelect(); SPI.transfer(MCP_BITMOD); SPI.transfer(addr); SPI.transfer(mask); SPI.transfer(val); mcpDeselect();
+}
+
+uint8_t CanBus::sendAsync(uint16_t id, uint8_t len, const uint8_t* data, TxPrio prio){
+  pollTx();
+  uint8_t b = 0;
+  while(b < TX_BUFFERS && _txb[b] == TxState::Pending) b++;
+  if(b >= TX_BUFFERS) return TX_NONE;
+  if(len > 8) len = 8;
+
+  // TXBnCTRL..TXBnD7 are contiguous: priority, 11-bit ID, DLC and data in one burst
+  mcpSelect();
+  SPI.transfer(MCP_WRITE); SPI.transfer(txbCtrl(b));
+  SPI.transfer((uint8_t)prio & MCP_TXB_TXP10_M);
+  SPI.transfer((uint8_t)(id >> 3)); SPI.transfer((uint8_t)((id & 0x07) << 5));
+  SPI.transfer(0); SPI.transfer(0);
+  SPI.transfer(len);
+  for(uint8_t i=0;i<len;i++) SPI.transfer(data[i]);
+  mcpDeselect();
+
+  _txb[b] = TxState::Pending;
+  mcpSelect(); SPI.transfer((uint8_t)(0x80 | (1u << b))); mcpDeselect();   // RTS TXBn
+  return b;
+}
+
+void CanBus::pollTx(){
+  uint8_t busy = 0;
+  for(uint8_t b=0;b<TX_BUFFERS;b++) if(_txb[b] == TxState::Pending) busy |= (uint8_t)(1u << b);
+  if(!busy) return;
+
+  const uint8_t st = mcpReadStatus();
+  uint8_t doneIf = 0;
+  for(uint8_t b=0;b<TX_BUFFERS;b++){
+    const uint8_t bit = (uint8_t)(1u << b);
+    if(!(busy & bit) || (st & (0x04 << (2 * b)))) continue;   // not ours / TXREQ still set
+    const uint8_t ctrl = mcpRead(txbCtrl(b));
+    if(!(ctrl & MCP_TXB_ABTF_M))    { _txb[b] = TxState::Sent;    _txCnt.sent++; }
+    else if(_txAbortReq & bit)      { _txb[b] = TxState::Aborted; _txCnt.aborted++; }
+    else if(ctrl & MCP_TXB_MLOA_M)  { _txb[b] = TxState::ArbLost; _txCnt.arbLost++; }   // one-shot only
+    else                            { _txb[b] = TxState::Error;   _txCnt.errors++; }
+    _txAbortReq &= (uint8_t)~bit;
+    doneIf |= (uint8_t)(MCP_TX0IF << b);
+  }
+  if(doneIf) mcpBitMod(MCP_CANINTF, doneIf, 0);
+}
+
+bool CanBus::txAbort(uint8_t txb){
+  if(txb >= TX_BUFFERS || _txb[txb] != TxState::Pending) return false;
+  _txAbortReq |= (uint8_t)(1u << txb);
+  mcpBitMod(txbCtrl(txb), MCP_TXB_TXREQ_M, 0);   // a frame already on the wire still completes
+  return true;
+}
+void CanBus::txAbortAll(){
+  for(uint8_t b=0;b<TX_BUFFERS;b++) (void)txAbort(b);
+  _txCount = 0;
+}
+bool CanBus::setTxOneShot(bool on){
+  return (on ? _can.enOneShotTX() : _can.disOneShotTX()) == CAN_OK;
+}
+
+// ================= statistics =================
+void CanBus::noteRx(uint8_t slot, uint32_t t){
+  IdStats &s = _idStats[slot];
+  if(s.rx){
+    const uint32_t g32 = t - s.lastT;
+    const uint16_t g = g32 > 0xFFFEu ? 0xFFFEu : (uint16_t)g32;
+    if(g < s.gapMin) s.gapMin = g;
+    if(g > s.gapMax) s.gapMax = g;
+    s.gapSum += g;
+  }
+  s.lastT = t;
+  if(s.rx != 0xFFFF) s.rx++;
+}
+void CanBus::resetStats(){
+  memset(_idStats, 0, sizeof(_idStats));
+  for(uint8_t i=0;i<CanIds::COUNT;i++) _idStats[i].gapMin = 0xFFFF;
+  memset(&_busStats, 0, sizeof(_busStats));
+  memset(&_txCnt, 0, sizeof(_txCnt));
+  uint8_t sreg = SREG; cli(); _rxOverflow = 0; SREG = sreg;
+}
+void CanBus::pollErrors(){
+  const uint8_t e = mcpRead(MCP_EFLG);
+  if(e & MCP_EFLG_RX0OVR) _busStats.hwOverflow++;
+  if(e & MCP_EFLG_RX1OVR) _busStats.hwOverflow++;
+  if(e & (MCP_EFLG_RX0OVR | MCP_EFLG_RX1OVR)) mcpBitMod(MCP_EFLG, MCP_EFLG_RX0OVR | MCP_EFLG_RX1OVR, 0);  // latched until cleared
+
+  const uint8_t passive = MCP_EFLG_TXEP | MCP_EFLG_RXEP;
+  if((e & passive) && !(_eflgPrev & passive)) _busStats.errPassive++;
+  if((e & MCP_EFLG_TXBO) && !(_eflgPrev & MCP_EFLG_TXBO)) _busStats.busOff++;
+  _eflgPrev = e;
+}
+
+// ================= timed TX queue =================
+bool CanBus::scheduleTx(uint16_t id, uint8_t len, const uint8_t* data, uint16_t delayMs, TxPrio prio){
+  if(_txCount >= TX_Q_CAP) return false;
+  const uint32_t due = millis() + delayMs;
+  uint8_t i = _txCount;                       // insertion keeps _txQ[0] the earliest
+  while(i > 0 && (int32_t)(_txQ[i-1].due - due) > 0){ _txQ[i] = _txQ[i-1]; i--; }
+  TxJob &j = _txQ[i];
+  j.due = due; j.id = id; j.len = (len > 8) ? 8 : len; j.prio = prio;
+  for(uint8_t k=0;k<j.len;k++) j.data[k]=data[k];
+  _txCount++;
+  return true;
+}
+void CanBus::tickTx(){
+  pollTx();
+  const uint32_t now = millis();
+  while(_txCount && (int32_t)(now - _txQ[0].due) >= 0){
+    if(sendAsync(_txQ[0].id, _txQ[0].len, _txQ[0].data, _txQ[0].prio) == TX_NONE) return;   // retry next tick
+    _txCount--;
+    for(uint8_t i=0;i<_txCount;i++) _txQ[i]=_txQ[i+1];
+  }
+}
+
+// ================= loopback bench load =================
+bool CanBus::benchStart(uint16_t fps){
+  if(!fps || _benchFps) return false;
+  if(_can.setMode(MCP_LOOPBACK) != CAN_OK) return false;
+  _benchFps = fps; _benchT0 = millis(); _benchOffered = 0; _benchBacklog = 0;
+  return true;
+}
+void CanBus::benchStop(){
+  if(!_benchFps) return;
+  _benchFps = 0;
+  txAbortAll();
+  pollTx();
+  (void)_can.setMode(MCP_NORMAL);
+}
+void CanBus::tickBench(){
+  if(!_benchFps) return;
+  const uint32_t due = (millis() - _benchT0) * _benchFps / 1000u;
+  while(_benchOffered < due){
+    const uint8_t d[8] = { (uint8_t)_benchSeq, (uint8_t)(_benchSeq >> 8), 0xBE, 0, 0, 0, 0, 0 };
+    if(sendAsync(ID_AIRBAG, 8, d, TxPrio::Low) == TX_NONE) break;   // all buffers busy
+    _benchOffered++; _benchSeq++;
+  }
+  const uint32_t lag = due - _benchOffered;
+  _benchBacklog = lag > 0xFFFF ? 0xFFFF : (uint16_t)lag;
+}
+
+// ================= KOMBI sweep =================
 void CanBus::updateKL15_fromB0(uint8_t b0){
   if(b0!=_lastB0) _lastB0=b0;
   bool acc=(b0&0x01), run15=(b0&0x04), start=(b0&0x08);
@@ -82,17 +321,18 @@ void CanBus::updateKL15_fromB0(uint8_t b0){
 void CanBus::sendKombiPL(const uint8_t* pl, uint8_t len){
   uint8_t buf[8]={0}; buf[0]=0x60; buf[1]=len;
   for(uint8_t i=0;i<len && i<6;i++) buf[2+i]=pl[i];
-  _can.sendMsgBuf(0x6F1, 0, 2+len, buf);
+  (void)scheduleTx(0x6F1, 2+len, buf, 0);
+  (void)scheduleTx(0x6F1, 2+len, buf, BURST_GAP_MS);
+  _swBusyUntil = millis() + 2u*BURST_GAP_MS;          // the old blocking burst returned after 2 gaps
 }
-void CanBus::sendBurst(const uint8_t* pl, uint8_t len){ for(uint8_t i=0;i<2;i++){ sendKombiPL(pl,len); delay(30); } }
 const uint8_t SPD_STOP[] = {0x30,0x20,0x00};
 const uint8_t TAC_STOP[] = {0x30,0x21,0x00};
-void CanBus::spdStop(){ sendBurst(SPD_STOP,sizeof(SPD_STOP)); }
-void CanBus::tacStop(){ sendBurst(TAC_STOP,sizeof(TAC_STOP)); }
+void CanBus::spdStop(){ sendKombiPL(SPD_STOP,sizeof(SPD_STOP)); }
+void CanBus::tacStop(){ sendKombiPL(TAC_STOP,sizeof(TAC_STOP)); }
 uint16_t CanBus::kmh_to_raw(uint16_t kmh){ uint32_t n=(uint32_t)kmh*1777u; return (uint16_t)((n+50u)/100u); }
 uint16_t CanBus::rpm_to_raw(uint16_t rpm){ uint32_t n=(uint32_t)rpm*106u;  return (uint16_t)((n+62u)/125u); }
-void CanBus::spdMax(){ uint16_t r=kmh_to_raw(_targetKmh); uint8_t pl[5]={0x30,0x20,0x06,(uint8_t)(r>>8),(uint8_t)r}; sendBurst(pl,5); }
-void CanBus::tacMax(){ uint16_t r=rpm_to_raw(_targetRpm); uint8_t pl[5]={0x30,0x21,0x06,(uint8_t)(r>>8),(uint8_t)r}; sendBurst(pl,5); }
+void CanBus::spdMax(){ uint16_t r=kmh_to_raw(_targetKmh); uint8_t pl[5]={0x30,0x20,0x06,(uint8_t)(r>>8),(uint8_t)r}; sendKombiPL(pl,5); }
+void CanBus::tacMax(){ uint16_t r=rpm_to_raw(_targetRpm); uint8_t pl[5]={0x30,0x21,0x06,(uint8_t)(r>>8),(uint8_t)r}; sendKombiPL(pl,5); }
 void CanBus::tickSweep(){
   if(!_sweepEnabled) return;
   const uint32_t now=millis();
@@ -102,6 +342,7 @@ void CanBus::tickSweep(){
   }
   if(_swState==SW_IDLE) return;
   if(!_kl15On){ _swState=SW_IDLE; return; }
+  if((int32_t)(now - _swBusyUntil) < 0) return;      // bursts stay sequential, never interleaved
   if((int32_t)(now - _swDeadline) < 0) return;
 
   switch(_swState){
@@ -229,38 +470,44 @@ bool CanBus::nextKeyEvent(KeyEvent &ev){
 // --- Voltage decode helper (0x3B4) ---
 void CanBus::handleVoltage_3B4(const uint8_t* buf, uint8_t len){
   if(len < 3) return;
-  uint16_t raw = (uint16_t)(((buf[1] & 0x0F) << 8) | buf[0]);
-  float v = 0.0147059f * raw;      // same scale you’re using
-  _lastVoltage = v;
+  _lastVoltageMv = E60Sig::Voltage_mV::get<uint16_t>(buf);   // 12 bits x 0.0147059 V, integer only
   _voltageSeen = true;
 }
 
-// --- dispatcher (single, merged) ---
-void CanBus::onFrame(uint32_t id, uint8_t len, const uint8_t *buf){
-  const uint32_t now = millis();
+// --- dispatcher: perfect-hash slot -> {ID, min DLC, decoder}; other IDs cost nothing ---
+uint8_t CanBus::onFrame(uint32_t id, uint8_t len, const uint8_t *buf){
+  static constexpr Route kRoutes[] PROGMEM = {   // CAN_SUBSCRIBED_IDS order
+    { ID_CCID,       8, nullptr    },   // decoded in Filter
+    { ID_KEYBTN,     3, rKey       },
+    { ID_DOORS2,     3, rDoors     },
+    { ID_KL15,       1, rKL15      },
+    { ID_BUTTON,     2, nullptr    },   // decoded in Filter
+    { ID_HANDBRAKE,  6, rHandbrake },
+    { ID_AIRBAG,     1, nullptr    },
+    { ID_BATT_CHECK, 3, rVoltage   },
+  };
+  static_assert(CanIds::inSlotOrder(kRoutes), "CanBus::onFrame routes out of CAN_SUBSCRIBED_IDS order");
 
-  if      (id == ID_KL15     && len>=1) updateKL15_fromB0(buf[0]);
-  else if (id == ID_DOORS2   && len>=3) handleDoors_2FC(buf, len, now);
-  else if (id == ID_HANDBRAKE&& len>=6) handleHandbrake_1B4(buf, len, now);
-  else if (id == ID_KEYBTN   && len>=3) handleKey_23A(buf, len, now);
-  else if (id == 0x3B4       && len>=3) handleVoltage_3B4(buf, len);  // battery voltage
+  const uint8_t slot = CanIds::slotOf(id);
+  if(slot == CanIds::NO_SLOT) return CanIds::NO_SLOT;
+  Route r; memcpy_P(&r, &kRoutes[slot], sizeof(r));
+  if(len < r.minDlc){ _idStats[slot].dlcReject++; return CanIds::NO_SLOT; }
+  if(r.fn) r.fn(*this, buf, len, millis());
+  return slot;
 }
 
 
 // --- Blocking convenience: wait for a 0x3B4 up to timeoutMs ---
-bool CanBus::readVoltage(float& outV, uint16_t timeoutMs){
+bool CanBus::readVoltageMv(uint16_t& outMv, uint16_t timeoutMs){
   uint32_t start = millis();
   do {
     uint32_t id; uint8_t len; uint8_t buf[8];
     if(readOnceDistinct(id, len, buf)){
-      // keep other subsystems in sync
-      onFrame(id, len, buf);
-
-      if(id == 0x3B4 && len >= 3){
-        uint16_t raw = (uint16_t)(((buf[1] & 0x0F) << 8) | buf[0]);
-        outV = 0.0147059f * raw;
-        _lastVoltage = outV;
-        _voltageSeen = true;
+      // keep other subsystems in sync (0x3B4 is decoded by its route)
+      const uint8_t slot = onFrame(id, len, buf);
+      LatTrace::frameEnd();
+      if(slot == CanIds::slotOfC(ID_BATT_CHECK)){
+        outMv = _lastVoltageMv;
         return true;
       }
     }
@@ -3,7 +3,16 @@
 #include <SPI.h>
 #include "mcp_can.h"
 #include "Pins.h"
+#include "CanIds.h"
+#include "LatencyTrace.h"
 
+// CAN RX interrupt source for RxMode::Interrupt.
+// SoftwareSerial (DF_LINK_SOFTSERIAL) defines every PCINT vector on AVR, so with it INT (D8)
+// is sampled from the Timer0 compare-B tick (~1 kHz, well inside the 2-frame HW buffer).
+// The other DF links leave the PCINT vectors free: the D8 pin-change interrupt is used directly.
+#ifndef CAN_RX_USE_PCINT
+#define CAN_RX_USE_PCINT (DF_LINK != DF_LINK_SOFTSERIAL)
+#endif
 
 class CanBus {
 public:
@@ -11,14 +20,74 @@ public:
 
   bool begin();
 
+  // RX path: Polled asks the MCP2515 over SPI on every read; Interrupt drains RXB0/RXB1
+  // from ISR context into a RAM ring so a blocked main loop does not lose frames.
+  enum class RxMode : uint8_t { Polled, Interrupt };
+  void setRxMode(RxMode m) { _rxMode = m; }   // call before begin()
+  RxMode rxMode() const { return _rxMode; }
+  uint16_t rxOverflows() const;              // frames dropped because the RX ring was full
+
+  // ISR entry (RxMode::Interrupt only) — not for loop() use
+  static void isrService();
+  void rxWatchdog();                         // call every loop: re-drains if INT is stuck LOW
+
   // Read next *distinct* frame (de-duplicated within a small time window)
   bool readOnceDistinct(uint32_t &id, uint8_t &len, uint8_t *buf);
 
   // Feed every received frame here; updates snapshots, queues change events, keeps sweep state.
-  void onFrame(uint32_t id, uint8_t len, const uint8_t *buf);
+  // Runs exactly one decoder via the slot-indexed route table; returns the CanIds slot that
+  // passed its DLC gate (callers key their own per-ID stages on it), or CanIds::NO_SLOT.
+  uint8_t onFrame(uint32_t id, uint8_t len, const uint8_t *buf);
 
   // KOMBI sweep tick
   void tickSweep();
+  bool sweepActive() const { return _swState != SW_IDLE || _txCount; }
+
+  // Async TX on TXB0..TXB2: load + request-to-send, returns before the frame is on the bus.
+  // Outcome comes from TXBnCTRL/CANINTF, harvested by pollTx() (tickTx() calls it).
+  enum class TxPrio  : uint8_t { Low = 0, Mid, High, Top };     // TXBnCTRL.TXP: Top wins inside the MCP2515
+  enum class TxState : uint8_t { Idle, Pending, Sent, ArbLost, Error, Aborted };
+  static const uint8_t TX_BUFFERS = 3, TX_NONE = 0xFF;
+  uint8_t sendAsync(uint16_t id, uint8_t len, const uint8_t* data, TxPrio prio = TxPrio::Mid); // buffer or TX_NONE
+  TxState txState(uint8_t txb) const { return txb < TX_BUFFERS ? _txb[txb] : TxState::Idle; }
+  void pollTx();
+  bool txAbort(uint8_t txb);                 // clears TXREQ; reported as Aborted by the next poll
+  void txAbortAll();                        // pending buffers + frames still in the timed queue
+  bool setTxOneShot(bool on);                // CANCTRL.OSM (all buffers): no retransmit after error/arb loss
+  struct TxCounters { uint16_t sent, arbLost, errors, aborted; };
+  TxCounters txCounters() const { return _txCnt; }
+
+  // ---- Bus statistics (per subscribed ID + MCP2515 error flags) ----
+  // Inter-arrival gaps use the RX timestamp of every frame, duplicates included.
+  struct IdStats {
+    uint16_t rx, dup, dlcReject;
+    uint16_t gapMin, gapMax;                 // ms (gapMin = 0xFFFF until two frames seen)
+    uint32_t gapSum, lastT;                  // 18 B per slot: min/avg/max answer the tuning questions
+    uint16_t gapAvg() const { return rx > 1 ? (uint16_t)(gapSum / (uint32_t)(rx - 1)) : 0; }
+  };
+  struct BusStats {
+    uint16_t unsubscribed;                   // passed the HW filters but not in CanIds
+    uint16_t hwOverflow;                     // EFLG RX0OVR/RX1OVR occurrences
+    uint16_t errPassive, busOff;             // entries into TXEP|RXEP / TXBO
+    uint16_t rxKicks;                        // rxWatchdog() found INT stuck LOW and drained
+  };
+  const IdStats& idStats(uint8_t slot) const { return _idStats[slot]; }
+  const BusStats& busStats() const { return _busStats; }
+  void resetStats();                         // also zeroes rxOverflows() and txCounters()
+  void pollErrors();                         // sample EFLG; call every loop
+
+  // ---- Bench load: MCP2515 in loopback (off the car bus) receives its own frames ----
+  // ID_AIRBAG frames (no decoder, no Filter stage) with a running counter, paced to fps by
+  // tickBench(); they take the full ISR -> ring -> de-dup -> router path. Bench use only.
+  bool benchStart(uint16_t fps);
+  void benchStop();                          // aborts pending bench frames, back to MCP_NORMAL
+  bool benchActive() const { return _benchFps != 0; }
+  uint16_t benchBacklog() const { return _benchBacklog; }   // frames not offered: all TX buffers busy
+  void tickBench();
+
+  // Timed TX queue: frames leave from tickTx() once due and a TX buffer is free; nothing here sleeps.
+  bool scheduleTx(uint16_t id, uint8_t len, const uint8_t* data, uint16_t delayMs = 0, TxPrio prio = TxPrio::Low);
+  void tickTx();
 
   // ---- KOMBI sweep config (unchanged) ----
   void enableSweep(bool on) { _sweepEnabled = on; }
@@ -28,7 +97,6 @@ public:
     _spdDelay = speedDelayMs; _rpmDelay = rpmDelayMs; _peakDwell = peakDwellMs; _startAfterKL15 = startAfterMs;
   }
   void setDedupWindow(uint16_t ms) { _dedupWindowMs = ms; }
-  void setHistoryDepth(uint8_t depth) { _historyDepth = (depth>10)?10:depth; }
 
   // ================== STATE API ==================
 
@@ -76,24 +144,43 @@ public:
   struct KeyEvent { KeyEventType type; uint32_t t_ms; };
   bool nextKeyEvent(KeyEvent &ev);
   // ---- Voltage (0x3B4) ----
-  bool  readVoltage(float& outV, uint16_t timeoutMs = 100); // blocking helper (wait up to timeout)
+  bool  readVoltageMv(uint16_t& outMv, uint16_t timeoutMs = 100); // blocking helper (wait up to timeout)
   bool  voltageValid() const { return _voltageSeen; }        // have we seen a 0x3B4 yet?
-  float lastVoltage() const { return _lastVoltage; }         // latest decoded voltage
+  uint16_t lastVoltageMv() const { return _lastVoltageMv; }   // latest decoded voltage (mV)
   bool kl15On() const { return _kl15On; };
 
 private:
   // ===== raw + de-dup =====
   MCP_CAN _can;
-  struct FrameRec { uint32_t id; uint8_t len; uint8_t data[8]; uint32_t t; bool valid; };
-  static const uint8_t MAX_HISTORY = 10;
-  FrameRec _hist[MAX_HISTORY];
-  uint8_t  _histHead;
-  uint8_t  _historyDepth;
+  uint8_t _csPin;
+  // One slot per subscribed ID (CanIds.h): constant-time, unaffected by other IDs' traffic
+  struct DedupSlot { uint32_t t; uint8_t len; uint8_t data[8]; };   // len==0xFF: nothing seen yet
+  DedupSlot _dedup[CanIds::COUNT];
   uint16_t _dedupWindowMs;
 
-  bool readRaw(uint32_t &id, uint8_t &len, uint8_t *buf);
-  bool isDuplicate(uint32_t id, uint8_t len, const uint8_t *buf, uint32_t now) const;
-  void pushHistory(uint32_t id, uint8_t len, const uint8_t *buf, uint32_t now);
+  bool readRaw(uint32_t &id, uint8_t &len, uint8_t *buf, uint32_t &t, uint32_t &us);
+
+  // ===== statistics =====
+  IdStats  _idStats[CanIds::COUNT];
+  BusStats _busStats;
+  uint8_t  _eflgPrev = 0;
+  void noteRx(uint8_t slot, uint32_t t);
+
+  // ===== ISR-fed RX ring (SPSC: ISR owns _rxHead, main loop owns _rxTail) =====
+  struct RxFrame { uint16_t id; uint8_t len; uint8_t data[8]; uint32_t t; uint16_t us16; };   // us16: low micros() bits
+  static const uint8_t RX_RING_CAP = 8;    // power of two (7 usable): 17 B per entry on a 2 KB part
+  static_assert((RX_RING_CAP & (RX_RING_CAP - 1)) == 0, "RX_RING_CAP must be a power of two");
+  RxFrame _rxRing[RX_RING_CAP];
+  volatile uint8_t  _rxHead = 0, _rxTail = 0;
+  volatile uint16_t _rxOverflow = 0;
+  RxMode   _rxMode = RxMode::Polled;
+  volatile uint8_t* _intPort = nullptr;    // PIN register of PIN_CAN_INT
+  uint8_t  _intMask = 0;
+  static CanBus* _isrSelf;
+  static const uint8_t RX_READ_FAILS = 3;  // failed reads in a row with INT LOW: stop, watchdog retries
+  void drainRx();                          // ISR context
+  void rxIrqEnable(bool on);               // mask/unmask our RX source
+  bool isDuplicate(uint32_t id, uint8_t len, const uint8_t *buf, uint32_t now);  // records accepted frames
 
   // ===== KOMBI sweep =====
   bool _kl15On=false; uint8_t _lastB0=0xFF;
@@ -104,12 +191,42 @@ private:
   enum SweepState : uint8_t { SW_IDLE, SW_WAIT_DELAY, SW_TO_MAX_2, SW_PEAK, SW_TO_STOP_1, SW_TO_STOP_2 };
   SweepState _swState = SW_IDLE;
   uint32_t _swDeadline=0;
-  void sendKombiPL(const uint8_t* pl, uint8_t len);
-  void sendBurst(const uint8_t* pl, uint8_t len);
+  uint32_t _swBusyUntil=0;                             // last burst's copy has left; next step may run
+  void sendKombiPL(const uint8_t* pl, uint8_t len);   // schedules a 2-frame burst (30 ms apart)
+
+  // ===== timed TX queue (sorted by due time) =====
+  struct TxJob { uint32_t due; uint16_t id; uint8_t len; TxPrio prio; uint8_t data[8]; };
+  static const uint8_t TX_Q_CAP = 4;                  // one burst in flight + one stalled behind busy TX buffers
+  TxJob   _txQ[TX_Q_CAP];
+  uint8_t _txCount = 0;
+  static const uint16_t BURST_GAP_MS = 30;
+
+  // ===== bench load =====
+  uint16_t _benchFps = 0, _benchSeq = 0, _benchBacklog = 0;
+  uint32_t _benchT0 = 0, _benchOffered = 0;
+
+  // ===== MCP2515 TX buffers (own register access: MCP_CAN's sendMsgBuf blocks on TXREQ) =====
+  TxState    _txb[TX_BUFFERS] = { TxState::Idle, TxState::Idle, TxState::Idle };
+  uint8_t    _txAbortReq = 0;                // buffers whose TXREQ we cleared ourselves
+  TxCounters _txCnt = { 0, 0, 0, 0 };
+  void    mcpSelect();
+  void    mcpDeselect();
+  uint8_t mcpRead(uint8_t addr);
+  uint8_t mcpReadStatus();
+  void    mcpBitMod(uint8_t addr, uint8_t mask, uint8_t val);
   void spdStop(); void tacStop(); void spdMax(); void tacMax();
   uint16_t kmh_to_raw(uint16_t kmh); uint16_t rpm_to_raw(uint16_t rpm);
   void updateKL15_fromB0(uint8_t b0);
 
+  // ===== frame routing: one row per CanIds slot =====
+  typedef void (*Decoder)(CanBus&, const uint8_t*, uint8_t, uint32_t);
+  struct Route { uint16_t id; uint8_t minDlc; Decoder fn; };   // fn may be null (consumer-only ID)
+  static void rKL15(CanBus& c, const uint8_t* b, uint8_t, uint32_t)         { c.updateKL15_fromB0(b[0]); }
+  static void rDoors(CanBus& c, const uint8_t* b, uint8_t l, uint32_t t)    { c.handleDoors_2FC(b, l, t); }
+  static void rHandbrake(CanBus& c, const uint8_t* b, uint8_t l, uint32_t t){ c.handleHandbrake_1B4(b, l, t); }
+  static void rKey(CanBus& c, const uint8_t* b, uint8_t l, uint32_t t)      { c.handleKey_23A(b, l, t); }
+  static void rVoltage(CanBus& c, const uint8_t* b, uint8_t l, uint32_t)    { c.handleVoltage_3B4(b, l); }
+
   // ===== helpers =====
   static inline bool Bit(const uint8_t *b, uint8_t idx, uint8_t mask){ return (idx<8) ? ((b[idx]&mask)!=0) : false; }
 
@@ -139,6 +256,6 @@ private:
   void pushKeyEvent(KeyEventType t, uint32_t now);
   void handleKey_23A(const uint8_t *buf, uint8_t len, uint32_t now);
   void  handleVoltage_3B4(const uint8_t* buf, uint8_t len);
-  float _lastVoltage = NAN;
+  uint16_t _lastVoltageMv = 0;
   bool  _voltageSeen = false;
 };
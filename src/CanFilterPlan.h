@@ -0,0 +1,113 @@
+#pragma once
+#include <Arduino.h>
+#include "CanIds.h"
+
+// ===== Compile-time MCP2515 acceptance-filter plan =====
+// Derived from the subscribed ID list (CanIds.h); nothing here is hand-coded.
+//   RXB0 (high priority, rolls over into RXB1): mask 0 + filters 0..1, holds latency-critical IDs
+//   RXB1:                                        mask 1 + filters 2..5, holds everything else
+// Per buffer the planner tries every 11-bit mask, keeps those that fold the buffer's IDs into
+// no more classes than it has filters, and picks the one accepting the fewest IDs overall.
+namespace CanFilterPlan {
+
+using CanIds::kIds;
+using CanIds::COUNT;
+
+// Latency-critical IDs: CC-ID alerts and key-fob unlock (welcome) go to RXB0.
+constexpr bool isCritical(uint16_t id){ return id == ID_CCID || id == ID_KEYBTN; }
+
+constexpr uint16_t ALL_IDS = (uint16_t)((1u << COUNT) - 1u);   // set = bitmap over CanIds slots
+constexpr uint16_t criticalSet(uint8_t i = 0){
+  return i >= COUNT ? 0 : (uint16_t)((isCritical(kIds[i]) ? (1u << i) : 0u) | criticalSet((uint8_t)(i + 1)));
+}
+constexpr uint16_t RXB0_SET = criticalSet();
+constexpr uint16_t RXB1_SET = (uint16_t)(ALL_IDS & ~RXB0_SET);
+constexpr uint8_t  RXB0_FILTERS = 2, RXB1_FILTERS = 4;
+constexpr uint16_t FULL_MASK = 0x7FF;
+
+constexpr bool    inSet(uint16_t set, uint8_t i){ return ((set >> i) & 1u) != 0; }
+constexpr uint8_t pop11(uint16_t m, uint8_t b = 0){ return b >= 11 ? 0 : (uint8_t)(((m >> b) & 1u) + pop11(m, (uint8_t)(b + 1))); }
+
+// Is slot i the first member of its (id & mask) class within set?
+constexpr bool classLeader(uint16_t set, uint16_t m, uint8_t i, uint8_t j = 0){
+  return j >= i ? true
+       : ((inSet(set, j) && (kIds[j] & m) == (kIds[i] & m)) ? false : classLeader(set, m, i, (uint8_t)(j + 1)));
+}
+constexpr uint8_t classes(uint16_t set, uint16_t m, uint8_t i = 0){
+  return i >= COUNT ? 0 : (uint8_t)((inSet(set, i) && classLeader(set, m, i) ? 1 : 0) + classes(set, m, (uint8_t)(i + 1)));
+}
+// IDs accepted by a buffer = classes x 2^(don't-care bits); infeasible masks score worst
+constexpr uint32_t score(uint16_t set, uint16_t m, uint8_t nFilt){
+  return classes(set, m) <= nFilt ? ((uint32_t)classes(set, m) << (11 - pop11(m))) : 0xFFFFFFFFUL;
+}
+// Divide-and-conquer over [lo,hi) keeps constexpr recursion depth at log2(2048)
+constexpr uint16_t pick(uint16_t set, uint8_t nFilt, uint16_t a, uint16_t b){
+  return score(set, a, nFilt) < score(set, b, nFilt) ? a : b;   // ties -> higher mask value
+}
+constexpr uint16_t bestMask(uint16_t set, uint8_t nFilt, uint16_t lo = 0, uint16_t hi = FULL_MASK + 1){
+  return (hi - lo) == 1 ? lo
+       : pick(set, nFilt, bestMask(set, nFilt, lo, (uint16_t)((lo + hi) / 2)), bestMask(set, nFilt, (uint16_t)((lo + hi) / 2), hi));
+}
+constexpr uint16_t planMask(uint16_t set, uint8_t nFilt){ return set == 0 ? FULL_MASK : bestMask(set, nFilt); }
+
+// k-th class representative (filter value); spare filters repeat a subscribed ID
+constexpr uint16_t classRep(uint16_t set, uint16_t m, uint8_t k, uint8_t i = 0){
+  return i >= COUNT ? kIds[0]
+       : (inSet(set, i) && classLeader(set, m, i)) ? (k == 0 ? (uint16_t)(kIds[i] & m) : classRep(set, m, (uint8_t)(k - 1), (uint8_t)(i + 1)))
+       : classRep(set, m, k, (uint8_t)(i + 1));
+}
+constexpr uint16_t filterFor(uint16_t set, uint16_t m, uint8_t k){
+  return k < classes(set, m) ? classRep(set, m, k) : (set ? classRep(set, m, 0) : kIds[0]);
+}
+
+constexpr uint16_t MASK0 = planMask(RXB0_SET, RXB0_FILTERS);
+constexpr uint16_t MASK1 = planMask(RXB1_SET, RXB1_FILTERS);
+
+// ---- Encoding for MCP_CAN::init_Mask/init_Filt(num, ext = 0, word) ----
+// mcp2515_write_mf() takes the standard ID from bits 16..26 of the word (SIDH/SIDL) and writes
+// bits 0..15 to EID8/EID0, which for standard frames match data bytes 0 and 1. So the 11-bit
+// value goes in << 16 and the low half stays 0 (mask: payload don't-care).
+constexpr uint32_t libWord(uint16_t sid){ return (uint32_t)sid << 16; }
+
+// Register bytes write_mf() produces from a word (ext = 0), and the SID the MCP2515 compares
+constexpr uint8_t  regSIDH(uint32_t w){ return (uint8_t)((uint16_t)(w >> 16) >> 3); }
+constexpr uint8_t  regSIDL(uint32_t w){ return (uint8_t)(((uint16_t)(w >> 16) & 0x07) << 5); }
+constexpr uint8_t  regEID8(uint32_t w){ return (uint8_t)((uint16_t)w >> 8); }
+constexpr uint8_t  regEID0(uint32_t w){ return (uint8_t)w; }
+constexpr uint16_t regSid(uint32_t w){ return (uint16_t)(((uint16_t)regSIDH(w) << 3) | (regSIDL(w) >> 5)); }
+
+constexpr uint32_t kMask[2] PROGMEM = { libWord(MASK0), libWord(MASK1) };
+constexpr uint32_t kFilt[6] PROGMEM = {
+  libWord(filterFor(RXB0_SET, MASK0, 0)), libWord(filterFor(RXB0_SET, MASK0, 1)),
+  libWord(filterFor(RXB1_SET, MASK1, 0)), libWord(filterFor(RXB1_SET, MASK1, 1)),
+  libWord(filterFor(RXB1_SET, MASK1, 2)), libWord(filterFor(RXB1_SET, MASK1, 3))
+};
+
+// ---- Proof of coverage (evaluated by the compiler, on the register contents) ----
+// A standard frame is accepted when its SID matches under the SID mask and data bytes 0/1 match
+// EID8/EID0 under the EID mask; with EID masks of 0 the payload never matters.
+constexpr bool hit(uint16_t id, uint32_t m, uint32_t f){ return (id & regSid(m)) == (regSid(f) & regSid(m)); }
+constexpr bool hitsRxb0(uint16_t id){ return hit(id, kMask[0], kFilt[0]) || hit(id, kMask[0], kFilt[1]); }
+constexpr bool hitsRxb1(uint16_t id, uint8_t f = 2){ return f >= 6 ? false : (hit(id, kMask[1], kFilt[f]) || hitsRxb1(id, (uint8_t)(f + 1))); }
+constexpr bool passes(uint16_t id){ return hitsRxb0(id) || hitsRxb1(id); }
+constexpr bool payloadFree(uint8_t m){ return regEID8(kMask[m]) == 0 && regEID0(kMask[m]) == 0; }
+
+constexpr bool allPass(uint8_t i = 0){ return i >= COUNT ? true : (passes(kIds[i]) && allPass((uint8_t)(i + 1))); }
+constexpr bool criticalInRxb0(uint8_t i = 0){
+  return i >= COUNT ? true : ((!isCritical(kIds[i]) || hitsRxb0(kIds[i])) && criticalInRxb0((uint8_t)(i + 1)));
+}
+constexpr uint16_t countPassing(uint16_t lo = 0, uint16_t hi = FULL_MASK + 1){
+  return (hi - lo) == 1 ? (passes(lo) ? 1 : 0)
+       : (uint16_t)(countPassing(lo, (uint16_t)((lo + hi) / 2)) + countPassing((uint16_t)((lo + hi) / 2), hi));
+}
+
+static_assert(classes(RXB0_SET, MASK0) <= RXB0_FILTERS, "CanFilterPlan: too many critical IDs for RXB0");
+static_assert(regSid(kMask[0]) == MASK0 && regSid(kMask[1]) == MASK1, "CanFilterPlan: SID mask lost in the register encoding");
+static_assert(payloadFree(0) && payloadFree(1), "CanFilterPlan: EID8/EID0 mask bits would filter on data bytes");
+static_assert(allPass(), "CanFilterPlan: a subscribed ID would be rejected by the MCP2515");
+static_assert(criticalInRxb0(), "CanFilterPlan: latency-critical ID not in RXB0");
+
+// Standard IDs that pass the hardware filters without being subscribed (diagnostics)
+constexpr uint16_t UNWANTED_PASSING = (uint16_t)(countPassing() - COUNT);
+
+} // namespace CanFilterPlan
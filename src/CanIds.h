@@ -0,0 +1,62 @@
+#pragma once
+#include <Arduino.h>
+#include "Pins.h"
+
+// ===== Subscribed CAN IDs =====
+// Every ID a decoder consumes. List order = slot index used by per-ID tables (de-dup, ...).
+// One edit here updates the slot table and the perfect-hash index below.
+#define CAN_SUBSCRIBED_IDS(X) \
+  X(ID_CCID)     X(ID_KEYBTN)    X(ID_DOORS2) X(ID_KL15) \
+  X(ID_BUTTON)   X(ID_HANDBRAKE) X(ID_AIRBAG) X(ID_BATT_CHECK)
+
+namespace CanIds {
+
+#define CANIDS_ENTRY(id) (uint16_t)(id),
+constexpr uint16_t kIds[] PROGMEM = { CAN_SUBSCRIBED_IDS(CANIDS_ENTRY) };
+#undef CANIDS_ENTRY
+
+constexpr uint8_t COUNT   = sizeof(kIds) / sizeof(kIds[0]);
+constexpr uint8_t NO_SLOT = 0xFF;
+
+// ---- Perfect hash: 11-bit ID -> 16-entry LUT -> slot (two shifts + xor, no loop) ----
+constexpr uint8_t HASH_SIZE = 16;
+constexpr uint8_t hashOf(uint16_t id){ return (uint8_t)(((id >> 6) ^ (id << 2)) & (HASH_SIZE - 1)); }
+
+constexpr uint8_t slotForHash(uint8_t h, uint8_t i = 0){
+  return i >= COUNT ? NO_SLOT : (hashOf(kIds[i]) == h ? i : slotForHash(h, (uint8_t)(i + 1)));
+}
+constexpr bool collisionFree(uint8_t i = 0, uint8_t j = 1){
+  return i >= COUNT ? true
+       : j >= COUNT ? collisionFree((uint8_t)(i + 1), (uint8_t)(i + 2))
+       : (hashOf(kIds[i]) != hashOf(kIds[j]) && collisionFree(i, (uint8_t)(j + 1)));
+}
+static_assert(COUNT <= HASH_SIZE, "CanIds: more subscribed IDs than hash slots");
+static_assert(collisionFree(), "CanIds: hash collision - retune hashOf() shifts for the new ID list");
+
+constexpr uint8_t kSlotOfHash[HASH_SIZE] PROGMEM = {
+  slotForHash(0),  slotForHash(1),  slotForHash(2),  slotForHash(3),
+  slotForHash(4),  slotForHash(5),  slotForHash(6),  slotForHash(7),
+  slotForHash(8),  slotForHash(9),  slotForHash(10), slotForHash(11),
+  slotForHash(12), slotForHash(13), slotForHash(14), slotForHash(15)
+};
+
+// Compile-time slot (for static tables / static_assert)
+constexpr uint8_t slotOfC(uint16_t id){
+  return (slotForHash(hashOf(id)) != NO_SLOT && kIds[slotForHash(hashOf(id))] == id) ? slotForHash(hashOf(id)) : NO_SLOT;
+}
+
+// Runtime: ID -> slot, or NO_SLOT when the ID is not subscribed
+inline uint8_t slotOf(uint32_t id){
+  if(id > 0x7FF) return NO_SLOT;   // extended / RTR flags
+  const uint8_t s = pgm_read_byte(&kSlotOfHash[hashOf((uint16_t)id)]);
+  return (s != NO_SLOT && pgm_read_word(&kIds[s]) == (uint16_t)id) ? s : NO_SLOT;
+}
+inline uint16_t idAt(uint8_t slot){ return pgm_read_word(&kIds[slot]); }
+
+// Slot-indexed tables (one row per subscribed ID, member .id) must follow the list order
+template<class Row, size_t N>
+constexpr bool inSlotOrder(const Row (&rows)[N], uint8_t i = 0){
+  return N == COUNT && (i >= N || (rows[i].id == kIds[i] && inSlotOrder(rows, (uint8_t)(i + 1))));
+}
+
+} // namespace CanIds
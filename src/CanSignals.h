@@ -0,0 +1,99 @@
+#pragma once
+#include <Arduino.h>
+
+// ===== Declarative CAN signal decoding (DBC-style) =====
+// A signal is a type: start bit, length, byte order, signedness, scale (NUM/DEN) and offset.
+// Everything is resolved at compile time, so a decode is a few byte loads, shifts and at most one
+// integer multiply — no loops, no floats, no divisions on the AVR.
+//
+//   typedef CanSig::Signal<0, 12, CanSig::Intel, false, 250, 17> VoltageMv;   // 0.0147059 V/bit -> mV
+//   uint16_t mv = VoltageMv::get<uint16_t>(buf);
+//
+// Bit numbering follows DBC: bit = byte*8 + bit-in-byte (LSB = 0).
+//   Intel    (little endian): START is the signal LSB.
+//   Motorola (big endian):    START is the signal MSB.
+namespace CanSig {
+
+enum ByteOrder : uint8_t { Intel, Motorola };
+
+// ---- tiny type helpers (no <type_traits> on avr-gcc) ----
+template<bool C, class A, class B> struct Select             { typedef A type; };
+template<class A, class B>         struct Select<false, A, B> { typedef B type; };
+template<uint8_t NBYTES> struct Word {
+  typedef typename Select<(NBYTES <= 1), uint8_t,
+          typename Select<(NBYTES <= 2), uint16_t, uint32_t>::type>::type type;
+};
+
+// ---- unrolled byte gather: FIRST..FIRST+N-1 packed little- or big-endian ----
+template<class W, uint8_t FIRST, uint8_t K, uint8_t N, bool LE>
+struct Gather {
+  static inline W get(const uint8_t* d){
+    return (W)((W)d[FIRST + K] << (8 * (LE ? K : (N - 1 - K)))) | Gather<W, FIRST, K + 1, N, LE>::get(d);
+  }
+};
+template<class W, uint8_t FIRST, uint8_t N, bool LE>
+struct Gather<W, FIRST, N, N, LE> { static inline W get(const uint8_t*){ return 0; } };
+
+// ---- scale selection: phys = ((raw * MUL + ROUND) >> SHIFT) + OFFSET ----
+// Picks the largest SHIFT (<=24) whose product still fits 31 bits for every raw value.
+constexpr uint64_t mulFor(uint32_t num, uint32_t den, uint8_t s){ return (((uint64_t)num << s) + den / 2) / den; }
+constexpr bool     fits(uint32_t rawMax, uint32_t num, uint32_t den, uint8_t s){
+  return (uint64_t)rawMax * mulFor(num, den, s) + ((uint64_t)1 << s) < 0x80000000ULL;
+}
+constexpr uint8_t  shiftFor(uint32_t rawMax, uint32_t num, uint32_t den, uint8_t s = 24){
+  return (den == 1 || s == 0) ? 0 : (fits(rawMax, num, den, s) ? s : shiftFor(rawMax, num, den, (uint8_t)(s - 1)));
+}
+
+template<uint8_t START, uint8_t LEN, ByteOrder BO = Intel, bool SIGNED = false,
+         uint32_t NUM = 1, uint32_t DEN = 1, int32_t OFFSET = 0>
+struct Signal {
+  static_assert(LEN >= 1 && LEN <= 32, "CanSig: signal length 1..32");
+  static_assert(NUM >= 1 && DEN >= 1,  "CanSig: scale NUM/DEN must be positive");
+
+  static constexpr uint8_t FIRST = START / 8;
+  static constexpr uint8_t LAST  = (BO == Intel) ? (uint8_t)((START + LEN - 1) / 8)
+                                                 : (uint8_t)(FIRST + (LEN + 6 - START % 8) / 8);
+  static constexpr uint8_t NBYTES  = LAST - FIRST + 1;
+  static constexpr uint8_t MIN_DLC = LAST + 1;
+  static_assert(LAST < 8, "CanSig: signal runs past byte 7");
+  static_assert(NBYTES <= 4, "CanSig: signal spans more than 4 bytes");
+  static_assert(BO == Motorola || START % 8 + LEN <= 32, "CanSig: Intel signal spans more than 32 bits");
+
+  typedef typename Word<NBYTES>::type W;
+  typedef typename Word<(LEN + 7) / 8>::type RawT;
+  static constexpr uint8_t LSB_POS = (BO == Intel) ? (uint8_t)(START % 8)
+                                                   : (uint8_t)(8 * (NBYTES - 1) + START % 8 - (LEN - 1));
+  static constexpr uint32_t RAW_MAX = (LEN >= 32) ? 0xFFFFFFFFUL : ((1UL << LEN) - 1UL);
+
+  static constexpr uint8_t  SHIFT = shiftFor(SIGNED ? (RAW_MAX >> 1) + 1 : RAW_MAX, NUM, DEN);
+  static constexpr uint32_t MUL   = (DEN == 1) ? NUM : (uint32_t)mulFor(NUM, DEN, SHIFT);
+
+  // Raw unsigned bits
+  static inline RawT raw(const uint8_t* d){
+    return (RawT)((Gather<W, FIRST, 0, NBYTES, BO == Intel>::get(d) >> LSB_POS) & (W)RAW_MAX);
+  }
+
+  // Physical value (integer units chosen by NUM/DEN/OFFSET)
+  template<class T>
+  static inline T get(const uint8_t* d){
+    const RawT r = raw(d);
+    int32_t v;
+    if (SIGNED && LEN < 32 && (r & (RawT)(1UL << (LEN - 1)))) v = (int32_t)r - (int32_t)(1UL << (LEN - 1)) * 2;
+    else                                                      v = (int32_t)r;
+    if (NUM != 1 || DEN != 1) {
+      v = (DEN == 1) ? v * (int32_t)MUL
+                     : (int32_t)((v * (int32_t)MUL + (SHIFT ? (int32_t)(1L << (SHIFT - 1)) : 0)) >> SHIFT);
+    }
+    return (T)(v + OFFSET);
+  }
+
+  static inline bool flag(const uint8_t* d){ return raw(d) != 0; }
+};
+
+// Minimum DLC covering every signal of a message
+template<class S>
+constexpr uint8_t minDlc(){ return S::MIN_DLC; }
+template<class S, class S2, class... Rest>
+constexpr uint8_t minDlc(){ return S::MIN_DLC > minDlc<S2, Rest...>() ? S::MIN_DLC : minDlc<S2, Rest...>(); }
+
+} // namespace CanSig
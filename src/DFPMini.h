@@ -4,7 +4,7 @@
 //
 // Supports: play by index, play by folder/file, next/prev, volume/EQ/mode,
 // device select, pause/resume, reset/standby, repeat, and queries.
-// Works with any Arduino Stream (HardwareSerial, SoftwareSerial).
+// Works with any Arduino Stream (HardwareSerial, SoftwareSerial, TX-only timer UART).
 //
 // Protocol per "MP3‑TF‑16P / DFPlayer Mini" datasheet:
 // Frame: 0x7E, 0xFF, 0x06, CMD, FEEDBACK(0/1), PARAM_H, PARAM_L, CHK_H, CHK_L, 0xEF
@@ -59,11 +59,14 @@ public:
     uint8_t   raw[10]; // last full raw frame for debugging (0..9 filled)
   };
 
-  DFPMini() : _serial(nullptr), _busyPin(0xFF), _busyActiveLow(true), _bufIndex(0), _queueHead(0), _queueTail(0) {}
+  DFPMini() : _serial(nullptr), _busyPin(0xFF), _busyActiveLow(true), _bufIndex(0), _queueHead(0), _queueTail(0),
+              _cmdHead(0), _cmdTail(0), _inFlight(false), _duplex(true), _tries(0), _sentMs(0) { resetCmdStats(); }
 
   // Begin with any Stream (HardwareSerial, SoftwareSerial, etc.).
-  void begin(Stream &s, uint8_t busyPin=0xFF, bool busyActiveLow=true) {
+  // duplex=false: nothing comes back (TX-only link); the pipeline paces by SIMPLEX_GAP_MS instead of ACKs.
+  void begin(Stream &s, uint8_t busyPin=0xFF, bool busyActiveLow=true, bool duplex=true) {
     _serial = &s;
+    _duplex = duplex;
     _busyPin = busyPin;
     _busyActiveLow = busyActiveLow;
     if (_busyPin != 0xFF) {
@@ -71,6 +74,7 @@ public:
     }
     resetParser();
     clearEvents();
+    clearPipeline();
   }
 
   // ======== High‑level controls (non‑blocking) ========
@@ -100,19 +104,51 @@ public:
     return send(0x10, (enable?0x0100:0x0000) | (gain & 0x1F), fb);
   }
   bool setRepeat(bool enable, bool fb=false){ return send(0x11, enable?1:0, fb); }
+  // Single-track cycle of the track now playing (send after PLAY); the module repeats it on its own
+  bool loopCurrent(bool enable, bool fb=false){ return send(0x19, enable?0:1, fb); }
 
-  // ======== Queries (responses arrive as events) ========
-  bool queryStatus()       { return send(0x42, 0, true); } // playing/paused etc.
-  bool queryVolume()       { return send(0x43, 0, true); }
-  bool queryEQ()           { return send(0x44, 0, true); }
-  bool queryPlayMode()     { return send(0x45, 0, true); }
-  bool querySWVersion()    { return send(0x46, 0, true); }
-  bool queryTFTotal()      { return send(0x47, 0, true); }
-  bool queryUTotal()       { return send(0x48, 0, true); }
-  bool queryFlashTotal()   { return send(0x49, 0, true); }
-  bool queryTFCurTrack()   { return send(0x4B, 0, true); }
-  bool queryUCurTrack()    { return send(0x4C, 0, true); }
-  bool queryFlashCurTrack(){ return send(0x4D, 0, true); }
+  // ======== Queries (through the ACK pipeline; responses arrive as events) ========
+  bool queryStatus()       { return enqueue(0x42, 0); } // playing/paused etc.
+  bool queryVolume()       { return enqueue(0x43, 0); }
+  bool queryEQ()           { return enqueue(0x44, 0); }
+  bool queryPlayMode()     { return enqueue(0x45, 0); }
+  bool querySWVersion()    { return enqueue(0x46, 0); }
+  bool queryTFTotal()      { return enqueue(0x47, 0); }
+  bool queryUTotal()       { return enqueue(0x48, 0); }
+  bool queryFlashTotal()   { return enqueue(0x49, 0); }
+  bool queryTFCurTrack()   { return enqueue(0x4B, 0); }
+  bool queryUCurTrack()    { return enqueue(0x4C, 0); }
+  bool queryFlashCurTrack(){ return enqueue(0x4D, 0); }
+
+  // ======== Acknowledged pipeline ========
+  // Commands go out one at a time with feedback=1; the next leaves when the module ACKs (0x41).
+  // ERROR (0x40) or no ACK within ACK_TIMEOUT_MS resends, at most MAX_TRIES sends per command.
+  // ACK/ERROR frames answering the pipeline are consumed here, not queued as events.
+  // TX-only link (begin(..., duplex=false)): feedback=0, one send each, SIMPLEX_GAP_MS apart.
+  static const uint16_t ACK_TIMEOUT_MS   = 120;  // 2 x 10.4 ms frame at 9600 Bd + module processing
+  static const uint16_t ERROR_BACKOFF_MS = 30;   // resend delay after an ERROR reply
+  static const uint8_t  MAX_TRIES        = 3;
+  static const uint16_t SIMPLEX_GAP_MS   = 40;   // TX-only link: frame + module parse, no ACK to wait for
+
+  struct CmdStats {
+    uint16_t sent, acked, retries, failed;
+    uint8_t  lastCmd;
+    uint16_t rttLastMs, rttMinMs, rttMaxMs;
+    uint32_t rttSumMs;                           // over 'acked'
+  };
+
+  bool enqueue(uint8_t cmd, uint16_t param) {
+    const uint8_t n = (uint8_t)((_cmdHead + 1) & (CMDQ_SZ-1));
+    if (n == _cmdTail) return false;             // full
+    _cmdQ[_cmdHead].cmd = cmd; _cmdQ[_cmdHead].param = param;
+    _cmdHead = n;
+    pumpPipeline();
+    return true;
+  }
+  bool pipelineIdle() const { return !_inFlight && _cmdHead == _cmdTail; }
+  void clearPipeline() { _cmdHead = _cmdTail = 0; _inFlight = false; }
+  const CmdStats& cmdStats() const { return _stats; }
+  void resetCmdStats() { _stats = CmdStats(); _stats.rttMinMs = 0xFFFF; }
 
   // ======== Polling: call in loop() to parse inbound frames ========
   void update() {
@@ -121,6 +157,7 @@ public:
       uint8_t b = (uint8_t)_serial->read();
       parseByte(b);
     }
+    pumpPipeline();
   }
 
   // Busy (if a BUSY pin is wired). Returns true if "playing".
@@ -165,6 +202,47 @@ public:
   }
 
 private:
+  // In-flight head of the command queue: send, await ACK, resend on ERROR/timeout
+  void pumpPipeline() {
+    if (_inFlight) {
+      if ((uint32_t)(millis() - _sentMs) < (_duplex ? ACK_TIMEOUT_MS : SIMPLEX_GAP_MS)) return;
+      if (!_duplex) finishHead();                // open loop: spacing only
+      else retryOrDrop();                        // ACK went missing
+      if (_inFlight) return;
+    }
+    if (_cmdHead == _cmdTail) return;
+    _tries = 0;
+    transmitHead();
+  }
+  void transmitHead() {
+    const Cmd &c = _cmdQ[_cmdTail];
+    if (_tries) _stats.retries++;
+    _tries++;
+    _stats.sent++;
+    _inFlight = true;
+    _sentMs = millis();
+    (void)send(c.cmd, c.param, _duplex);
+  }
+  void retryOrDrop() {
+    if (_tries < MAX_TRIES) { transmitHead(); return; }
+    _stats.failed++;
+    finishHead();
+  }
+  void finishHead() {
+    _inFlight = false;
+    _cmdTail = (uint8_t)((_cmdTail + 1) & (CMDQ_SZ-1));
+  }
+  void onAck() {
+    const uint16_t rtt = (uint16_t)(millis() - _sentMs);
+    _stats.acked++;
+    _stats.lastCmd = _cmdQ[_cmdTail].cmd;
+    _stats.rttLastMs = rtt;
+    if (rtt < _stats.rttMinMs) _stats.rttMinMs = rtt;
+    if (rtt > _stats.rttMaxMs) _stats.rttMaxMs = rtt;
+    _stats.rttSumMs += rtt;
+    finishHead();
+  }
+
   // Simple state machine to parse 10‑byte frames
   void parseByte(uint8_t b) {
     if (_bufIndex == 0) {
@@ -194,6 +272,12 @@ private:
   void pushEventFromFrame(const uint8_t* f) {
     uint8_t cmd = f[3];
     uint16_t param = (uint16_t(f[5])<<8) | f[6];
+    if (_inFlight && cmd == EV_ACK)   { onAck(); pumpPipeline(); return; }
+    if (_inFlight && cmd >= EV_STATUS && cmd == _cmdQ[_cmdTail].cmd) onAck();   // query answered (some clones skip the ACK)
+    if (_inFlight && cmd == EV_ERROR) {                              // busy / bad frame: resend soon
+      _sentMs = millis() - (ACK_TIMEOUT_MS - ERROR_BACKOFF_MS);
+      return;
+    }
     Event ev{};
     ev.type = (EventType)cmd;
     ev.param = param;
@@ -225,6 +309,17 @@ private:
   // ring queue
   Event _queue[QUEUE_SZ];
   uint8_t _queueHead, _queueTail;
+
+  // acknowledged command queue
+  struct Cmd { uint8_t cmd; uint16_t param; };
+  static const uint8_t CMDQ_SZ = 8;             // power of two; 7 usable
+  Cmd      _cmdQ[CMDQ_SZ];
+  uint8_t  _cmdHead, _cmdTail;
+  bool     _inFlight;
+  bool     _duplex;
+  uint8_t  _tries;
+  uint32_t _sentMs;
+  CmdStats _stats;
 };
 
 #endif // DFPMINI_H
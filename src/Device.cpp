@@ -1,11 +1,14 @@
 #include "Device.h"
 
+static Stream& Cli = DfLink::console();   // USB Serial, or the TX-only debug channel (DF_LINK_HWSERIAL)
+
 // =================== CLI ===================
+// With DF_LINK_HWSERIAL the channel is TX-only: available() stays 0 and nothing is parsed.
 void Device::parseCLI(){
   static String line;
-  while(Serial.available()){
-    char c = (char)Serial.read();
-    if(c=='\r'){ if(Serial.peek()=='\n') (void)Serial.read(); c='\n'; }
+  while(Cli.available()){
+    char c = (char)Cli.read();
+    if(c=='\r'){ if(Cli.peek()=='\n') (void)Cli.read(); c='\n'; }
     if(c=='\n'){
       line.trim();
       if(line.length()){
@@ -14,19 +17,39 @@ void Device::parseCLI(){
           String digits; for(uint16_t i=1;i<line.length();++i){ char ch=line[i]; if(ch>='0'&&ch<='9') digits+=ch; else if(ch!=' ') { digits=""; break; } }
           long n = digits.length()?digits.toInt():-1;
           if(n>=1 && n<=DF_MAX_MP3){
-            if(player.isPlaying()) player.stop();
-            player.playTrack((uint16_t)n);
+            LatTrace::setActive(LatTrace::NONE);
+            player.requestPlay((uint16_t)n);
           }
         } else if(cmd=='v' || cmd=='V'){
-          if(line.length()==2 && (line[1]=='?')){ Serial.print(F("[CLI] volume=")); Serial.println(player.volume()); }
+          if(line.length()==2 && (line[1]=='?')){
+            Cli.print(F("[CLI] volume=")); Cli.print(player.volume());
+            Cli.print(F(" df=")); Cli.println(player.shadow().volume);   // 255 = unknown
+            player.verifyShadow();                                           // re-read; next "v?" shows it
+          }
           else if(line.length()==2 && (line[1]=='+'||line[1]=='-')){
             int cur=(int)player.volume(); if(line[1]=='+') cur++; else cur--; if(cur<0)cur=0; if(cur>Player::DF_VOLUME_MAX)cur=Player::DF_VOLUME_MAX;
-            player.setVolume((uint8_t)cur); Serial.print(F("[CLI] volume=")); Serial.println(player.volume());
+            player.setVolume((uint8_t)cur); Cli.print(F("[CLI] volume=")); Cli.println(player.volume());
           } else {
             String digits; for(uint16_t i=1;i<line.length();++i){ char ch=line[i]; if(ch>='0'&&ch<='9') digits+=ch; else if(ch!=' ') { digits=""; break; } }
             long v = digits.length()?digits.toInt():-1;
-            if(v>=0 && v<=Player::DF_VOLUME_MAX){ player.setVolume((uint8_t)v); Serial.print(F("[CLI] volume set ")); Serial.println(player.volume()); }
+            if(v>=0 && v<=Player::DF_VOLUME_MAX){ player.setVolume((uint8_t)v); Cli.print(F("[CLI] volume set ")); Cli.println(player.volume()); }
+          }
+        } else if(cmd=='s' || cmd=='S'){
+          if(line.length()==2 && line[1]=='0'){ filter.resetCanStats(); Cli.println(F("[CLI] CAN stats reset")); }
+          else dumpCanStats();
+        } else if(cmd=='d' || cmd=='D'){
+          if(line.length()==2 && line[1]=='0'){ player.resetBootLearn(); Cli.println(F("[CLI] DF boot times forgotten")); }
+          else dumpDfTiers();
+        } else if(cmd=='b' || cmd=='B'){
+          if(line.length()==2 && line[1]=='0'){ if(bench.fps){ filter.stopCanBench(); bench.fps=0; bench.report=true; } }
+          else {
+            String digits; for(uint16_t i=1;i<line.length();++i){ char ch=line[i]; if(ch>='0'&&ch<='9') digits+=ch; else if(ch!=' ') { digits=""; break; } }
+            long f = digits.length()?digits.toInt():BENCH_FPS_DEFAULT;
+            if(f>=1 && f<=2000) benchStart((uint16_t)f);
           }
+        } else if(cmd=='l' || cmd=='L'){
+          if(line.length()==2 && line[1]=='0'){ LatTrace::reset(); Cli.println(F("[CLI] latency trace reset")); }
+          else dumpLatency((line.length()==2 && (line[1]=='a' || line[1]=='A')) ? 2 : 0);   // "la": A1/A2 only
         }
       }
       line="";
@@ -34,58 +57,291 @@ void Device::parseCLI(){
   }
 }
 
+// "s": per-ID counters, inter-arrival min/avg/max (ms), then bus-wide counters, active CC-IDs
+void Device::dumpCanStats(){
+  const CanBus& can = filter.can();
+  for(uint8_t s=0;s<CanIds::COUNT;s++){
+    const CanBus::IdStats& st = can.idStats(s);
+    Cli.print(F("[STAT] 0x")); Cli.print(CanIds::idAt(s), HEX);
+    Cli.print(F(" rx="));  Cli.print(st.rx);
+    Cli.print(F(" dup=")); Cli.print(st.dup);
+    Cli.print(F(" dlc=")); Cli.print(st.dlcReject);
+    if(st.rx > 1){
+      Cli.print(F(" gap=")); Cli.print(st.gapMin); Cli.print('/'); Cli.print(st.gapAvg());
+      Cli.print('/'); Cli.print(st.gapMax);
+    }
+    Cli.println();
+  }
+  const CanBus::BusStats& bs = can.busStats();
+  const CanBus::TxCounters tx = can.txCounters();
+  Cli.print(F("[STAT] unsub="));    Cli.print(bs.unsubscribed);
+  Cli.print(F(" hwOvr="));          Cli.print(bs.hwOverflow);
+  Cli.print(F(" ringOvr="));        Cli.print(can.rxOverflows());
+  Cli.print(F(" errPassive="));     Cli.print(bs.errPassive);
+  Cli.print(F(" busOff="));         Cli.print(bs.busOff);
+  Cli.print(F(" rxKicks="));        Cli.println(bs.rxKicks);
+  Cli.print(F("[STAT] tx sent="));  Cli.print(tx.sent);
+  Cli.print(F(" arbLost="));        Cli.print(tx.arbLost);
+  Cli.print(F(" err="));            Cli.print(tx.errors);
+  Cli.print(F(" abort="));          Cli.println(tx.aborted);
+  const Ccid::ActiveSet& act = filter.activeCcids();
+  Cli.print(F("[STAT] ccid active=")); Cli.print(act.count());
+  Cli.print(F(" A1="));    Cli.print(act.count(Ccid::A1));
+  Cli.print(F(" A2="));    Cli.print(act.count(Ccid::A2));
+  Cli.print(F(" A3="));    Cli.print(act.count(Ccid::A3));
+  Cli.print(F(" notif=")); Cli.print(act.count(Ccid::NOTIF));
+  Cli.print(F(" belt="));  Cli.print(act.seatbelts());
+  Cli.print(F(" merged=")); Cli.print(filter.ccidCoalesced());
+  Cli.print(F(" untracked=")); Cli.println(act.untracked());
+}
+
+// "l" / "la": RX -> stage latency percentiles over the last LatTrace::TRACE_CAP traced intents, then the intent queue
+void Device::dumpLatency(uint8_t minPrio){
+  static const char kStage[LatTrace::STAGES][9] PROGMEM = {
+    "rx", "accept", "handle", "post", "pop", "play", "busyLow", "relayOn"
+  };
+  if(!LATENCY_TRACE) Cli.println(F("[LAT] trace compiled out (build env nanoatmega328_trace)"));
+  for(uint8_t s=LatTrace::ACCEPT;s<LatTrace::STAGES;s++){
+    uint32_t p50, p90, pmax; uint8_t n;
+    Cli.print(F("[LAT] ")); Cli.print((const __FlashStringHelper*)kStage[s]);
+    if(!LatTrace::percentileUs((LatTrace::Stage)s, 50, minPrio, p50, n)){ Cli.println(F(" -")); continue; }
+    (void)LatTrace::percentileUs((LatTrace::Stage)s, 90,  minPrio, p90,  n);
+    (void)LatTrace::percentileUs((LatTrace::Stage)s, 100, minPrio, pmax, n);
+    Cli.print(F(" n="));   Cli.print(n);
+    Cli.print(F(" p50=")); Cli.print(p50);
+    Cli.print(F(" p90=")); Cli.print(p90);
+    Cli.print(F(" max=")); Cli.print(pmax); Cli.println(F(" us"));
+    if(s == LatTrace::RELAY_ON && minPrio >= 2){
+      Cli.print(F("[LAT] alerts audible within ")); Cli.print(ALERT_AUDIBLE_BOUND_US);
+      Cli.println(pmax <= ALERT_AUDIBLE_BOUND_US ? F(" us: OK") : F(" us: OVER"));
+    }
+  }
+  const Filter::SchedStats& ss = filter.schedStats();
+  Cli.print(F("[SCHED] queued="));  Cli.print(filter.intentsPending());
+  Cli.print(F(" peak="));       Cli.print(ss.peak);
+  Cli.print(F(" posted="));     Cli.print(ss.posted);
+  Cli.print(F(" coalesced="));  Cli.print(ss.coalesced);
+  Cli.print(F(" aged="));       Cli.print(ss.aged);
+  Cli.print(F(" evicted="));    Cli.print(ss.evicted);
+  Cli.print(F(" dropped="));    Cli.print(ss.dropped);
+  Cli.print(F(" limited="));    Cli.println(filter.rateLimited());
+}
+
+// "d": DF power tier now + average request -> relay ON latency per tier, breaker, learned boot times ("d0" forgets them)
+void Device::dumpDfTiers(){
+  static const char kTier[Player::TIERS][8] PROGMEM = { "off", "standby", "warm" };
+  Cli.print(F("[DF] state=")); Cli.println((uint8_t)player.state());
+  for(uint8_t t=0;t<Player::TIERS;t++){
+    const Player::TierStats& st = player.tierStats((Player::Tier)t);
+    Cli.print(F("[DF] ")); Cli.print((const __FlashStringHelper*)kTier[t]);
+    Cli.print(F(" n=")); Cli.print(st.n);
+    Cli.print(F(" avg=")); Cli.print(st.avgMs()); Cli.println(F(" ms"));
+  }
+  const DFPMini::CmdStats& cs = player.cmdStats();
+  Cli.print(F("[DF] cmd sent=")); Cli.print(cs.sent);
+  Cli.print(F(" acked="));   Cli.print(cs.acked);
+  Cli.print(F(" retries=")); Cli.print(cs.retries);
+  Cli.print(F(" failed="));  Cli.print(cs.failed);
+  if(cs.acked){
+    Cli.print(F(" rtt last(0x")); Cli.print(cs.lastCmd, HEX); Cli.print(F(")="));
+    Cli.print(cs.rttLastMs); Cli.print(F(" min/avg/max=")); Cli.print(cs.rttMinMs); Cli.print('/');
+    Cli.print((uint16_t)(cs.rttSumMs / cs.acked)); Cli.print('/'); Cli.print(cs.rttMaxMs); Cli.print(F(" ms"));
+  }
+  Cli.println();
+  static const char kHealth[3][9] PROGMEM = { "healthy", "degraded", "open" };
+  const Player::BreakerStats& br = player.breakerStats();
+  Cli.print(F("[DF] health=")); Cli.print((const __FlashStringHelper*)kHealth[(uint8_t)player.health()]);
+  Cli.print(F(" fails="));      Cli.print(br.failures);
+  Cli.print(F(" trips="));      Cli.print(br.trips);
+  Cli.print(F(" probes="));     Cli.print(br.probes);
+  Cli.print(F(" recovered="));  Cli.print(br.recoveries);
+  Cli.print(F(" refused="));    Cli.print(br.refused);
+  Cli.print(F(" coalesced="));  Cli.print(br.coalesced);
+  Cli.print(F(" backoff="));    Cli.print(player.breakerBackoffMs()); Cli.println(F(" ms"));
+  const Player::BootLearn& bl = player.bootLearn();
+  const Player::BootPhase* ph[2] = { &bl.init, &bl.ready };
+  for(uint8_t i=0;i<2;i++){
+    Cli.print(i ? F("[DF] boot ready") : F("[DF] boot init"));
+    Cli.print(F(" n=")); Cli.print(ph[i]->n);
+    if(ph[i]->n){
+      Cli.print(F(" min/avg/max=")); Cli.print(ph[i]->minMs); Cli.print('/');
+      Cli.print(ph[i]->avgMs); Cli.print('/'); Cli.print(ph[i]->maxMs); Cli.print(F(" ms"));
+    }
+    Cli.println();
+  }
+}
+
 // =================== Helpers ===================
 void Device::radioSet(bool on){
   pinMode(PIN_RADIO_HOLD, OUTPUT);
   digitalWrite(PIN_RADIO_HOLD, on ? HIGH : LOW);
-  Serial.print(F("[RADIO] ")); Serial.println(on?F("HIGH"):F("LOW"));
+  Cli.print(F("[RADIO] ")); Cli.println(on?F("HIGH"):F("LOW"));
 }
 
-void Device::playWelcome(){
-  if(player.isPlaying()) player.stop();
-  player.playTrack(1);
-  nowPlaying = NowPlaying::Welcome;
-  DBG(F("[PLAY] Welcome T1"));
+// =================== Audio scheduling ===================
+// Every intent waits in Filter's queue until it can play. Preemption compares raw prio (aging only
+// reorders the queue, it never cuts a clip):
+//   nothing in flight, or the seatbelt loop (background)  -> the best intent starts now
+//   a strictly higher class than the current clip         -> cuts it (A1 > A2 > A3 > notification)
+//   Welcome over another notification                     -> cuts it
+//   otherwise                                             -> waits; the Player pulls it on the
+//                                                            finish edge (nextClip) and chains it
+// While the breaker is open the queue is drained into the Player, which keeps the best intent for
+// its probe and counts the rest as refused/coalesced.
+bool Device::mayPreempt(const Filter::PlayIntent& pi) const {
+  if(!player.isPlaying() || player.isLooping()) return true;
+  const bool known = nowValid();
+  const uint8_t cur = known ? now.prio : 0;        // CLI "p" counts as a notification
+  if(pi.prio > cur) return true;
+  return pi.kind == Filter::Kind::Welcome && cur == 0 && !(known && now.welcome);
 }
 
-void Device::playTrackNow(uint16_t tr){
-  if(player.isPlaying()) player.stop();
-  player.playTrack(tr);
-  nowPlaying = NowPlaying::Other;
-  Serial.print(F("[PLAY] T")); Serial.println(tr);
+void Device::noteStarted(const Filter::PlayIntent& pi){
+  LatTrace::mark(pi.trace, LatTrace::POP);
+  LatTrace::setActive(pi.trace);
+  now.track = pi.track; now.prio = pi.prio; now.welcome = (pi.kind == Filter::Kind::Welcome);
+  Cli.print(F("[PLAY] T")); Cli.print(pi.track); Cli.print(F(" p")); Cli.println(pi.prio);
+}
+
+void Device::playIntent(const Filter::PlayIntent& pi){
+  noteStarted(pi);
+  player.requestPlay(pi.track);
+}
+
+void Device::schedule(){
+  const uint32_t t = millis();
+  Filter::PlayIntent e;
+  if(!player.acceptsRequests()){                   // breaker open: the Player refuses and holds one
+    if(!filter.popIntent(e, t)) return;            // for the probe; hand it the best one last
+    Filter::PlayIntent rest;
+    while(filter.popIntent(rest, t)) player.requestPlay(rest.track);
+    player.requestPlay(e.track);
+    return;
+  }
+  const Filter::PlayIntent* pi = filter.peekIntent(t);
+  if(!pi || !mayPreempt(*pi)) return;
+  (void)filter.popIntent(e, t);
+  playIntent(e);
+}
+
+uint16_t Device::nextClip(){
+  Filter::PlayIntent e;
+  if(!player.acceptsRequests() || !filter.popIntent(e, millis())) return 0;
+  noteStarted(e);
+  return e.track;
 }
 
 void Device::ensureSeatbeltLoop(){
-  // Filter keeps seatbelt state up to date from CC-ID; loop T2 when active.
+  // Filter keeps seatbelt state up to date from CC-ID; T2 repeats on the DF itself while active.
   if(!filter.state().seatbeltActive) return;
-  if(nowPlaying == NowPlaying::Welcome) return; // let welcome finish
   if(player.isPlaying() && player.currentTrack()==2) return;
-  if(player.isPlaying()) player.stop();
-  player.playTrack(2);
-  nowPlaying = NowPlaying::Other;
+  if(!player.acceptsRequests()) return;          // breaker open: the probe is not ours to spam
+  LatTrace::setActive(LatTrace::NONE);
+  player.requestPlay(2, /*loop*/true);
+  now = Now();
   DBG(F("[PLAY] Seatbelt T2 loop"));
 }
 
+void Device::onTrackFinished(uint16_t){
+  // Nothing queued was chained -> enforce seatbelt loop if needed
+  now = Now();
+  ensureSeatbeltLoop();
+}
+
 void Device::stopIfTrack(uint16_t tr){
   if(player.isPlaying() && player.currentTrack()==tr) player.stop();
 }
 
 bool Device::batteryOK(){
-  float v = filter.state().batteryV;
-  if (isnan(v)) {
+  const uint16_t mv = filter.state().batteryMv;
+  if (mv == 0) {
     if (FAILSAFE_NO_RADIO) {
-      Serial.println(F("[RADIO] No voltage yet -> keep OFF"));
+      Cli.println(F("[RADIO] No voltage yet -> keep OFF"));
       return false;
     }
     return true; // permissive if you relax FAILSAFE_NO_RADIO
   }
-  Serial.print(F("[RADIO] Battery=")); Serial.print(v, 2); Serial.println(F(" V"));
-  return (v >= RADIO_MIN_VOLT);
+  const uint16_t frac = mv % 1000;
+  Cli.print(F("[RADIO] Battery=")); Cli.print(mv / 1000); Cli.print('.');
+  if (frac < 100) Cli.print('0');
+  if (frac < 10)  Cli.print('0');
+  Cli.print(frac); Cli.println(F(" V"));
+  return (mv >= RADIO_MIN_MV);
+}
+
+void Device::trackLoopGaps(){
+  const uint32_t now = micros();
+  const uint32_t gap = now - loopPrevUs;
+  loopPrevUs = now;
+  benchTick(gap);
+
+  const bool active = filter.sweepActive();
+  if(active){
+    if(!sweepWasActive) sweepMaxGapUs = 0;
+    else if(gap > sweepMaxGapUs) sweepMaxGapUs = gap;
+  } else if(sweepWasActive){
+    Cli.print(F("[SWEEP] done, max loop stall ")); Cli.print(sweepMaxGapUs); Cli.println(F(" us"));
+  }
+  sweepWasActive = active;
+}
+
+// =================== Loopback bench ===================
+// "b[fps]" (default BENCH_FPS_DEFAULT, "b0" stops early): BENCH_MS of self-received CAN load while the
+// DF link carries queries; CAN stats are reset at the start, so "s" afterwards shows the bench traffic.
+void Device::benchStart(uint16_t fps){
+  if(bench.fps) return;
+  filter.resetCanStats();
+  if(!filter.startCanBench(fps)){ Cli.println(F("[BENCH] loopback mode refused")); return; }
+  const DFPMini::CmdStats& cs = player.cmdStats();
+  bench = Bench();
+  bench.fps = fps;
+  bench.t0 = bench.lastDfMs = millis();
+  bench.dfSent0 = cs.sent; bench.dfAcked0 = cs.acked; bench.dfFailed0 = cs.failed;
+  player.prewake();                                 // DF awake so the queries reach it
+  Cli.print(F("[BENCH] start ")); Cli.print(fps); Cli.println(F(" fps, off the car bus"));
+}
+
+void Device::benchTick(uint32_t gapUs){
+  if(!bench.fps) return;
+  if(bench.n != 0xFFFF){
+    bench.n++;
+    bench.gapSum += gapUs;
+    if(gapUs > bench.gapMax) bench.gapMax = gapUs;
+    if(gapUs > BENCH_STALL_US && bench.stalls != 0xFFFF) bench.stalls++;
+  }
+  const uint32_t now = millis();
+  if((uint32_t)(now - bench.lastDfMs) >= BENCH_DF_POLL_MS){ bench.lastDfMs = now; player.verifyShadow(); }
+  if((uint32_t)(now - bench.t0) >= BENCH_MS){ filter.stopCanBench(); bench.fps = 0; bench.report = true; }
+}
+
+void Device::benchReport(){
+  static const char kLink[3][8] PROGMEM = { "soft", "hwuart", "timertx" };
+  bench.report = false;
+  const CanBus& can = filter.can();
+  const CanBus::TxCounters tx = can.txCounters();
+  const uint16_t rx = can.idStats(CanIds::slotOfC(ID_AIRBAG)).rx;
+  const DFPMini::CmdStats& cs = player.cmdStats();
+  Cli.print(F("[BENCH] link=")); Cli.print((const __FlashStringHelper*)kLink[DF_LINK]);
+  Cli.print(F(" pcint=")); Cli.println(CAN_RX_USE_PCINT);
+  Cli.print(F("[BENCH] can sent=")); Cli.print(tx.sent);
+  Cli.print(F(" rx="));      Cli.print(rx);
+  Cli.print(F(" lost="));    Cli.print(tx.sent > rx ? tx.sent - rx : 0);
+  Cli.print(F(" hwOvr="));   Cli.print(can.busStats().hwOverflow);
+  Cli.print(F(" ringOvr=")); Cli.print(can.rxOverflows());
+  Cli.print(F(" behind="));  Cli.println(can.benchBacklog());
+  Cli.print(F("[BENCH] loop n=")); Cli.print(bench.n);
+  Cli.print(F(" avg="));     Cli.print(bench.n ? bench.gapSum / bench.n : 0);
+  Cli.print(F(" max="));     Cli.print(bench.gapMax);
+  Cli.print(F(" us stalls>")); Cli.print(BENCH_STALL_US / 1000); Cli.print(F("ms="));
+  Cli.println(bench.stalls);
+  Cli.print(F("[BENCH] df sent=")); Cli.print((uint16_t)(cs.sent - bench.dfSent0));
+  Cli.print(F(" acked="));   Cli.print((uint16_t)(cs.acked - bench.dfAcked0));
+  Cli.print(F(" failed="));  Cli.println((uint16_t)(cs.failed - bench.dfFailed0));
 }
 
 // =================== begin/loop ===================
 void Device::begin(){
-  Serial.begin(115200);
+  DfLink::consoleBegin();
   delay(100);
   DBG(F("Starting Device (Filter + Player)"));
 
@@ -94,10 +350,14 @@ void Device::begin(){
     DBG(F("MCP2515 init FAIL")); while(1) delay(1000);
   }
   DBG(F("MCP2515 OK (8MHz, 100kbps)"));
+  Cli.print(F("[CAN] filter plan: ")); Cli.print(CanFilterPlan::UNWANTED_PASSING);
+  Cli.println(F(" unsubscribed IDs pass"));
 
   // DFPlayer
   player.setBenchMode(false);
   player.begin();
+  player.setOnTrackFinished(trackFinishedThunk, this);
+  player.setNextClip(nextClipThunk, this);
 
   // RNG (for Filter's goodbye random choice)
   randomSeed(analogRead(A0));
@@ -107,13 +367,20 @@ void Device::begin(){
 
   // KL15 start mirror
   kl15Prev = filter.state().kl15On;
+
+  if(BENCH_BOOT_FPS) benchStart(BENCH_BOOT_FPS);
 }
 
 void Device::loop(){
+  trackLoopGaps();
   parseCLI();
 
   // Pump CAN + sweep + policies -> Filter emits intents
   filter.tick();
+  if(bench.report) benchReport();   // ring drained by the tick above
+
+  // Unlock / door / KL15 edge: start the DF boot before the intent that usually follows
+  if(filter.takePrewake()) player.prewake();
 
   // Radio policy on KL15 edge (optional keep-on-after-OFF)
   bool kl15Now = filter.state().kl15On;
@@ -125,56 +392,9 @@ void Device::loop(){
   }
   kl15Prev = kl15Now;
 
-  // SECURITY FIRST (A1/A2/A3)
-  {
-    Filter::PlayIntent pi;
-    if(filter.popSecurity(pi)){
-      // Any security intent preempts seatbelt loop
-      stopIfTrack(2);
-
-      // HandbrakeWarn or CCID or others: just play the mapped track
-      playTrackNow(pi.track);
-      return; // one play per loop
-    }
-  }
-
-  // NOTIFICATIONS (A4+B+Welcome/Goodbye/IgnGong)
-  {
-    Filter::PlayIntent pi;
-    if(filter.popNotification(pi)){
-      // Welcome takes precedence: always play immediately
-      if (pi.kind == Filter::Kind::Welcome){
-        playWelcome();
-        return;
-      }
-
-      // If Welcome is playing, defer other notifications
-      if (nowPlaying == NowPlaying::Welcome){
-        qPush(pi.track);                 // store track number only
-        return;
-      }
-
-      // Play mapped notification now
-      playTrackNow(pi.track);
-      return;
-    }
-  }
-
-  // Drain deferred notifications when a track ends
-  static bool wasPlaying = false;
-  bool isNowPlaying = player.isPlaying();
-  if (wasPlaying && !isNowPlaying){
-    // If Welcome just ended, drain deferred items first
-    uint16_t tr;
-    if (qPop(tr)){
-      playTrackNow(tr);
-    } else {
-      // Nothing deferred -> enforce seatbelt loop if needed
-      ensureSeatbeltLoop();
-      if(!player.isPlaying()) nowPlaying = NowPlaying::None;
-    }
-  }
-  wasPlaying = isNowPlaying;
+  // Audio: best queued intent starts now if the player is free or it may preempt; the rest wait
+  // for the Player's pull on the finish edge
+  schedule();
 
   // Key events (UNLOCK/LOCK) -> radio power with voltage guard
   CanBus::KeyEvent kev;
@@ -195,9 +415,9 @@ void Device::loop(){
     }
   }
 
-  // Keep seatbelt loop alive when nothing else is playing
+  // Seatbelt loop: start when nothing else plays; the DF repeat never ends on its own, so stop it on clear
   if(!player.isPlaying()) ensureSeatbeltLoop();
+  else if(!filter.state().seatbeltActive && player.isLooping()) stopIfTrack(2);
 
-  player.loop();
-  delay(2);
+  player.loop();   // raises onTrackFinished() when a track ends
 }
@@ -1,9 +1,14 @@
 #pragma once
 #include <Arduino.h>
-#include <math.h>
 #include "Pins.h"
 #include "Player.h"
 #include "Filter.h"
+#include "CanFilterPlan.h"
+
+// Loopback CAN bench at boot (frames/s, 0 = off): the HWSERIAL DF link leaves no CLI input for "b"
+#ifndef BENCH_BOOT_FPS
+#define BENCH_BOOT_FPS 0
+#endif
 
 class Device {
 public:
@@ -17,37 +22,66 @@ public:
 
 private:
   // ======= Config / constants =======
-  static constexpr float    RADIO_MIN_VOLT    = 11.8f;
+  static constexpr uint16_t RADIO_MIN_MV      = 11800;
   static constexpr bool     FAILSAFE_NO_RADIO = true;
+  static constexpr uint32_t ALERT_AUDIBLE_BOUND_US = 1500000UL;   // A1/A2 frame -> relay ON budget ("la")
+  static constexpr uint32_t BENCH_MS          = 10000;
+  static constexpr uint16_t BENCH_FPS_DEFAULT = 400;     // ~55 % of 100 kbps with 8-byte frames
+  static constexpr uint32_t BENCH_STALL_US    = 5000;    // loop gap counted as a stall
+  static constexpr uint16_t BENCH_DF_POLL_MS  = 250;     // DF queries during the bench (link traffic)
 
   // ======= Helpers =======
   static inline void DBG(const __FlashStringHelper* s){
 #if 1
-    Serial.println(s);
+    DfLink::console().println(s);
 #endif
   }
   void parseCLI();
+  void dumpCanStats();
+  void dumpLatency(uint8_t minPrio);
+  void dumpDfTiers();
+  void benchStart(uint16_t fps);
+  void benchTick(uint32_t gapUs);
+  void benchReport();
   void radioSet(bool on);
-  void playWelcome();
-  void playTrackNow(uint16_t tr);
+  void schedule();                                // start / preempt with the best queued intent
+  bool mayPreempt(const Filter::PlayIntent& pi) const;
+  void noteStarted(const Filter::PlayIntent& pi);
+  void playIntent(const Filter::PlayIntent& pi);
   void ensureSeatbeltLoop();
+  uint16_t nextClip();                            // Player pull on a natural end: best intent, chained
+  static uint16_t nextClipThunk(void* self){ return static_cast<Device*>(self)->nextClip(); }
+  void onTrackFinished(uint16_t track);           // Player event: nothing was left to chain
+  static void trackFinishedThunk(void* self, uint16_t track){ static_cast<Device*>(self)->onTrackFinished(track); }
   void stopIfTrack(uint16_t tr);
   bool  batteryOK();
 
-  // ======= Tiny deferral queue (for notifications blocked by Welcome) =======
-  struct QItem { uint16_t track; };
-  static constexpr uint8_t QCAP = 8;
-  QItem q[QCAP]; uint8_t qw=0, qr=0;
-  bool qPush(uint16_t tr){ uint8_t n=(uint8_t)(qw+1u)%QCAP; if(n==qr) return false; q[qw]={tr}; qw=n; return true; }
-  bool qPop(uint16_t& tr){ if(qr==qw) return false; tr=q[qr].track; qr=(uint8_t)(qr+1u)%QCAP; return true; }
-
   // ======= Members =======
-  enum class NowPlaying : uint8_t { None, Welcome, Other };
-  NowPlaying nowPlaying = NowPlaying::None;
+  // Intent behind the Player's current track (valid while player.currentTrack() == track)
+  struct Now { uint16_t track; uint8_t prio; bool welcome; };
+  Now now = {};
+  bool nowValid() const { return now.track && player.currentTrack() == now.track; }
 
   Filter filter;      // CAN ingest + KOMBI + state + play-intents
   Player player;
 
+  // Longest gap between loop() passes while a KOMBI sweep runs (reported when it ends)
+  uint32_t loopPrevUs = 0;
+  uint32_t sweepMaxGapUs = 0;
+  bool     sweepWasActive = false;
+  void     trackLoopGaps();
+
+  // Loopback bench ("b[fps]"): CAN frames lost + loop jitter under synthetic load, per DF link
+  struct Bench {
+    uint16_t fps;                      // 0: not running
+    bool     report;                   // stopped; report after the next CAN drain
+    uint32_t t0, lastDfMs;
+    uint16_t n, stalls;
+    uint32_t gapSum, gapMax;
+    uint16_t dfSent0, dfAcked0, dfFailed0;
+  };
+  Bench bench = {};
+
   // Radio hold after KL15 OFF (policy choice)
   bool kl15Prev = false;
   bool radioHeldAfterIgnOff = false;
@@ -0,0 +1,124 @@
+#include "DfLink.h"
+
+// ================= TimerTxUart: Timer2 CTC, one compare per bit, OC2B drives D3 =================
+#if DF_LINK != DF_LINK_SOFTSERIAL
+static_assert(PIN_DF_TX == 3 && PIN_DBG_TX == 3, "TimerTxUart drives OC2B, which is D3");
+
+static const uint8_t TT_IDLE = _BV(WGM21) | _BV(COM2B1) | _BV(COM2B0);   // OC2B set on match (mark)
+static const uint8_t TT_LOW  = _BV(WGM21) | _BV(COM2B1);                 // OC2B clear on match (space)
+
+uint8_t          TimerTxUart::_buf[TX_CAP];
+volatile uint8_t TimerTxUart::_head = 0, TimerTxUart::_tail = 0;
+volatile uint8_t TimerTxUart::_bit = 0;
+uint8_t          TimerTxUart::_cur = 0;
+uint16_t         TimerTxUart::_dropped = 0;
+
+ISR(TIMER2_COMPB_vect){ TimerTxUart::isrBit(); }
+
+void TimerTxUart::begin(uint32_t baud){
+  end();
+  uint32_t top = (F_CPU / 8 + baud / 2) / baud;   // timer counts per bit
+  if(top < 16)  top = 16;
+  if(top > 256) top = 256;
+  _head = _tail = _bit = 0;
+  digitalWrite(PIN_DF_TX, HIGH);
+  pinMode(PIN_DF_TX, OUTPUT);
+  TCCR2B = 0;
+  TCCR2A = TT_IDLE;
+  OCR2A  = (uint8_t)(top - 1);
+  OCR2B  = (uint8_t)(top - 1);
+  TCNT2  = 0;
+  TCCR2B = _BV(FOC2B);                            // line to mark now
+  TCCR2B = _BV(CS21);                             // clk/8: 9600 Bd -> 208 counts (+0.16 %)
+}
+
+void TimerTxUart::end(){
+  TIMSK2 &= (uint8_t)~_BV(OCIE2B);
+  TCCR2B = 0;
+  TCCR2A = 0;                                     // pin back to PORT (HIGH)
+  _head = _tail = _bit = 0;
+}
+
+uint8_t TimerTxUart::room(){ return (uint8_t)((_tail - _head - 1) & (TX_CAP - 1)); }
+int TimerTxUart::availableForWrite(){ return room(); }
+
+void TimerTxUart::put(uint8_t b){
+  _buf[_head] = b;
+  _head = (uint8_t)((_head + 1) & (TX_CAP - 1));
+}
+
+void TimerTxUart::kick(){
+  if(!(TIMSK2 & _BV(OCIE2B))){ TIFR2 = _BV(OCF2B); TIMSK2 |= _BV(OCIE2B); }
+}
+
+size_t TimerTxUart::write(uint8_t b){
+  if(!room()){ if(_dropped != 0xFFFF) _dropped++; return 0; }
+  put(b);
+  kick();
+  return 1;
+}
+
+size_t TimerTxUart::write(const uint8_t* buf, size_t n){
+  if(n > room()){ _dropped = (uint16_t)((_dropped + n > 0xFFFF) ? 0xFFFF : _dropped + n); return 0; }
+  for(size_t i = 0; i < n; i++) put(buf[i]);
+  kick();
+  return n;
+}
+
+void TimerTxUart::flush(){
+  while((TIMSK2 & _BV(OCIE2B)) && (SREG & _BV(SREG_I))) {}
+}
+
+// Runs just after a compare match switched the pin; programs the level of the next one,
+// so ISR latency up to ~one bit time (104 us at 9600 Bd) does not move any edge.
+void TimerTxUart::isrBit(){
+  uint8_t bit = _bit, mode;
+  if(bit == 0){
+    if(_tail == _head){ TIMSK2 &= (uint8_t)~_BV(OCIE2B); return; }   // stays at mark
+    _cur  = _buf[_tail];
+    _tail = (uint8_t)((_tail + 1) & (TX_CAP - 1));
+    mode = TT_LOW; bit = 1;                                          // start bit
+  } else if(bit <= 8){
+    mode = (_cur & 1) ? TT_IDLE : TT_LOW; _cur >>= 1; bit++;         // LSB first
+  } else {
+    mode = TT_IDLE; bit = 0;                                         // stop bit
+  }
+  _bit = bit;
+  TCCR2A = mode;
+}
+#endif
+
+// ================= transport selection =================
+namespace DfLink {
+
+#if DF_LINK == DF_LINK_SOFTSERIAL
+static SoftwareSerial s_df(PIN_DF_RX, PIN_DF_TX);
+Port&   port(){ return s_df; }
+Stream& console(){ return Serial; }
+#elif DF_LINK == DF_LINK_HWSERIAL
+static TimerTxUart s_dbg;
+Port&   port(){ return Serial; }
+Stream& console(){ return s_dbg; }
+#else
+static TimerTxUart s_df;
+Port&   port(){ return s_df; }
+Stream& console(){ return Serial; }
+#endif
+
+void open(){
+  Port& p = port();
+  p.end();                   // hard restart: no stale parser/line state after power or sleep
+  p.begin(DF_BAUD);
+}
+
+void close(){ port().end(); }
+
+void consoleBegin(){
+#if DF_LINK == DF_LINK_HWSERIAL
+  s_dbg.begin(CLI_BAUD);
+#else
+  Serial.begin(CLI_BAUD);
+#endif
+}
+
+} // namespace DfLink
@@ -0,0 +1,70 @@
+#pragma once
+#include <Arduino.h>
+#include "Pins.h"
+#if DF_LINK == DF_LINK_SOFTSERIAL
+#include <SoftwareSerial.h>
+#endif
+
+// ===== DFPlayer link transport + CLI channel (selected by DF_LINK in Pins.h) =====
+// SoftwareSerial holds IRQs off for a whole byte (~1 ms at 9600 Bd) on TX and on every RX
+// start bit, and owns all PCINT vectors. The alternatives:
+//   HWSERIAL  the USART does the bit timing; the CLI shrinks to a TX-only debug channel
+//             (TimerTxUart on D3, no input) because the USB side of D0/D1 now talks to the DF.
+//   TIMER_TX  TimerTxUart drives the DF: the pin is switched by the OC2B compare hardware, the
+//             ISR only picks the next level, so a late ISR (CAN drain) does not skew the bit.
+//             There is no RX: DFPMini runs its pipeline open-loop (no ACK, INIT or replies).
+
+// TX-only UART on Timer2 / OC2B (D3). One instance: it owns the timer.
+class TimerTxUart : public Stream {
+public:
+  void begin(uint32_t baud);                 // 7813..~57600 Bd (OCR2A at F_CPU/8)
+  void end();
+  // Never waits: a full ring drops. A byte at a time (console text) truncates; a buffer (a DF frame)
+  // goes in whole or not at all. The DF pipeline spaces its 10-byte frames far wider than they take.
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t* buf, size_t n) override;
+  using Print::write;
+  int  availableForWrite() override;
+  uint16_t dropped() const { return _dropped; }   // bytes refused on a full ring
+  int  available() override { return 0; }
+  int  read() override { return -1; }
+  int  peek() override { return -1; }
+  void flush() override;                     // until the last stop bit is on the wire
+
+  static void isrBit();                      // ISR entry — not for loop() use
+
+private:
+  static const uint8_t TX_CAP = 32;          // power of two
+  static uint8_t _buf[TX_CAP];
+  static volatile uint8_t _head, _tail;      // main owns _head, ISR owns _tail
+  static volatile uint8_t _bit;              // 0 idle/between bytes, 1..8 data, 9 stop
+  static uint8_t _cur;
+  static uint16_t _dropped;
+  static uint8_t room();
+  static void put(uint8_t b);
+  static void kick();
+};
+
+namespace DfLink {
+
+#if DF_LINK == DF_LINK_SOFTSERIAL
+typedef SoftwareSerial Port;
+#elif DF_LINK == DF_LINK_HWSERIAL
+typedef HardwareSerial Port;
+#else
+typedef TimerTxUart Port;
+#endif
+
+static const uint32_t DF_BAUD  = 9600;
+static const bool     DUPLEX   = DF_LINK != DF_LINK_TIMER_TX;   // DF replies come back
+static const bool     CLI_RX   = DF_LINK != DF_LINK_HWSERIAL;   // CLI accepts commands
+static const uint32_t CLI_BAUD = (DF_LINK == DF_LINK_HWSERIAL) ? 9600 : 115200;
+
+Port&   port();
+void    open();                              // (re)start at DF_BAUD
+void    close();
+
+Stream& console();                           // CLI + log output
+void    consoleBegin();
+
+} // namespace DfLink
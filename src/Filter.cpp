@@ -2,6 +2,7 @@
 
 // --- One-time init and KOMBI sweep config (kept disabled at boot) ---
 bool Filter::begin(){
+  _can.setRxMode(CanBus::RxMode::Interrupt);   // ISR drains MCP2515 through any loop stall (DF UART TX, Serial)
   if(!_can.begin()) return false;
 
   // KOMBI sweep configuration lives here (not in main)
@@ -11,83 +12,167 @@ bool Filter::begin(){
   _can.setSweepTiming(28, 35, 1000, 4000);
 
   _kl15Prev = _S.kl15On = _can.kl15On();
+  memset(_credit, 0xFF, sizeof(_credit));   // every bucket starts full
+  _rateT = millis();
   return true;
 }
 
-// --- CC-ID classification: A1/A2/A3 vs Notification ---
-Filter::EvClass Filter::classifyCcid(uint16_t ccid, uint8_t& prio){
-  // A1: Stop-Now
-  if (ccid==30 || ccid==33 || ccid==39 || ccid==212 || ccid==427 || ccid==961 || ccid==568 ||
-      ccid==257 || ccid==367 || ccid==74) { prio=3; return EvClass::SecA1; }
+// --- Queue posting helper: rate limit first, then the scheduler ---
+bool Filter::post(Kind k, uint16_t track, uint16_t ccid, uint8_t prio){
+  if (!rateAllow(k, track, prio)){ if (_rateRejected != 0xFFFF) _rateRejected++; return false; }
+  PlayIntent e{ k, track, ccid, prio, millis(), LatTrace::NONE };
+  PlayIntent* stored = _q.push(e);
+  if (stored) stored->trace = LatTrace::open(prio);   // traced only if it will reach POP on its own
+  return true;
+}
 
-  // A2: Drive-Now (seatbelt + doors/hood/trunk)
-  if (ccid==46 || ccid==91 || ccid==389 || ccid==390 ||
-      ccid==14 || ccid==15 || ccid==16 || ccid==17 || ccid==18 || ccid==19) { prio=2; return EvClass::SecA2; }
+// ===== Per-track rate limiting (token bucket in credits: 1 token = refillS credits) =====
+static_assert((uint8_t)Filter::Kind::Goodbye + 1 == Filter::KINDS, "Filter: _rate[] needs a row per Kind");
+
+void Filter::setRateLimit(Kind k, uint8_t burst, uint8_t refillS){
+  if (refillS && burst > 255 / refillS) burst = 255 / refillS;
+  _rate[(uint8_t)k].burst = burst;
+  _rate[(uint8_t)k].refillS = refillS;
+}
+
+bool Filter::rateAllow(Kind k, uint16_t track, uint8_t prio){
+  if (prio >= RATE_EXEMPT_PRIO) return true;   // safety warnings are never dropped here
+  const RateLimit& L = _rate[(uint8_t)k];
+  if (!L.refillS) return true;
+  uint8_t& c = _credit[track <= DF_MAX_MP3 ? track : DF_MAX_MP3];
+  const uint8_t cap = (uint8_t)(L.burst * L.refillS);
+  if (c > cap) c = cap;                   // a full bucket holds burst tokens, not more
+  if (c < L.refillS) return false;
+  c -= L.refillS;
+  return true;
+}
+
+void Filter::rateRefill(){
+  const uint32_t now = millis();
+  if ((uint32_t)(now - _rateT) < 1000) return;
+  _rateT += 1000;                          // a stalled loop catches up one second per pass
+  for (uint8_t i = 0; i <= DF_MAX_MP3; i++) if (_credit[i] != 0xFF) _credit[i]++;
+}
+
+// ===== Intent scheduler =====
+uint8_t Filter::IntentQueue::rank(const PlayIntent& e, uint32_t now){
+  if (e.prio >= AGE_CAP) return e.prio;
+  const uint32_t lv = e.prio + (uint32_t)(now - e.t_ms) / AGE_STEP_MS;
+  return lv >= AGE_CAP ? AGE_CAP : (uint8_t)lv;
+}
+
+int8_t Filter::IntentQueue::best(uint32_t now) const {
+  int8_t bi = -1; uint8_t br = 0;
+  for (uint8_t i = 0; i < n; i++){
+    const uint8_t r = rank(q[i], now);
+    if (bi < 0 || r > br){ bi = (int8_t)i; br = r; }   // strict: the older of equals stays
+  }
+  return bi;
+}
 
-  // A3: High-severity
-  if (ccid==29 || ccid==31 || ccid==49 || ccid==216 ||
-      ccid==213 ||
-      ccid==35 || ccid==236 || ccid==237 || ccid==382 ||
-      ccid==166 ||
-      ccid==306 || ccid==304 || ccid==229 || ccid==220 || ccid==415 ||
-      ccid==139 || ccid==143 || ccid==140 || ccid==141 ||
-      ccid==608 || ccid==609 || ccid==610 || ccid==611 ||
-      ccid==142 || ccid==265 ||
-      ccid==63  || ccid==384) { prio=1; return EvClass::SecA3; }
+Filter::PlayIntent* Filter::IntentQueue::push(const PlayIntent& e){
+  st.posted++;
+  for (uint8_t i = 0; i < n; i++){
+    if (q[i].track != e.track) continue;
+    if (e.prio > q[i].prio){ q[i].prio = e.prio; q[i].kind = e.kind; q[i].ccid = e.ccid; }
+    st.coalesced++;
+    return nullptr;
+  }
+  if (n == INTENT_CAP){
+    const uint32_t now = e.t_ms;
+    uint8_t lo = 0, lr = 0xFF;
+    for (uint8_t i = 0; i < n; i++){
+      const uint8_t r = rank(q[i], now);
+      if (r <= lr){ lo = i; lr = r; }                      // newest of the lowest rank
+    }
+    if (e.prio <= lr){ st.dropped++; return nullptr; }
+    LatTrace::cancel(q[lo].trace);                       // never reaches POP: keep it out of the stats
+    removeAt(lo);
+    st.evicted++;
+  }
+  q[n] = e;
+  if (++n > st.peak) st.peak = n;
+  return &q[n - 1];
+}
 
-  prio=0; return EvClass::Notif; // A4 + B
+bool Filter::IntentQueue::pop(PlayIntent& out, uint32_t now){
+  const int8_t i = best(now);
+  if (i < 0) return false;
+  out = q[i];
+  if (rank(out, now) > out.prio) st.aged++;
+  removeAt((uint8_t)i);
+  return true;
 }
 
-// --- Queue posting helper ---
-void Filter::post(EvClass cls, Kind k, uint16_t track, uint16_t ccid, uint8_t prio){
-  PlayIntent e{ k, track, ccid, prio, millis() };
-  if (cls == EvClass::Notif) { (void)_notQ.push(e); return; }
-  (void)_secQ.push(e);
+void Filter::IntentQueue::removeAt(uint8_t i){
+  n--;
+  for (; i < n; i++) q[i] = q[i + 1];
 }
 
 // --- Voltage update (0x3B4) -> battery flags ---
-void Filter::updateVoltage(float v){
-  _S.batteryV = v;
-  bool low = (v < _batLow);
+void Filter::updateVoltage(uint16_t mv){
+  _S.batteryMv = mv;
+  bool low = (mv < _batLowMv);
   if (low != _S.batteryLow){
     _S.batteryLow = low;
     // Sound for battery low comes via CC-ID mapping (T22); this just sets the level flag.
   }
 }
 
-// --- CC-ID frame handling: emit play-intents once per activation + mirrors ---
+// --- CC-ID frame handling: one intent per ACTIVE edge of each ID + mirrors ---
+// The KOMBI cycles through all active CC-IDs; the set remembers each one, so an ID only
+// re-announces after its own CLEARED, however many others come in between.
 void Filter::handleCcid(uint16_t ccid, uint8_t st){
-   // Special-case: some cars send CC-ID 0 as CLEARED (0x01) to indicate “All OK”.
+  // Some cars send CC-ID 0 as CLEARED (0x01) to indicate “All OK”: nothing is active any more.
   if (ccid == 0 && st == 0x01) {
-    // Play it once when transitioning out of a non-zero CC-ID context.
-    if (_lastCcid != 0 || _lastStatus == 0x02) {
-      post(EvClass::Notif, Kind::Ccid, trackForCcid(0), 0, /*prio*/0); // -> track 23
-      _lastCcid = 0; _lastStatus = 0x01;
-      return;
-    }
+    if (_okArmed) post(Kind::Ccid, trackForCcid(0), 0, /*prio*/0); // -> track 23
+    _okArmed = false;
+    _active.reset();
+    syncCcidMirrors();
+    return;
   }
-  if (st == 0x02) {  // ACTIVE
-    const bool armed = !(_lastCcid==ccid && _lastStatus==0x02);
-    _lastCcid = ccid; _lastStatus = 0x02;
-    _S.anyCcidActive = true;
-    if (!armed) return;
 
-    // mirrors
-    if (isSeatbeltCCID(ccid)) _S.seatbeltActive = true;
-    if (isLowFuelCCID(ccid) && _S.kl15On) _lowFuelSeenWhileIgnOn = true;
+  // one table lookup: track, A1/A2/A3/notification class, flags and bitmap row (CCIDMap.cpp)
+  const Ccid::Info ci = Ccid::lookup(ccid);
+  if (st == 0x02) {  // ACTIVE
+    if (!_active.set(ccid, ci)) return;   // still active: KOMBI repeating its list
+    _okArmed = true;
+    syncCcidMirrors();
+    if (ci.is(Ccid::LOW_FUEL) && _S.kl15On) _lowFuelSeenWhileIgnOn = true;
 
-    uint8_t pr; EvClass cls = classifyCcid(ccid, pr);
-    const uint16_t tr = trackForCcid(ccid); // from CCIDMap.h
-    post(cls, Kind::Ccid, tr, ccid, pr);
+    uint8_t slot;
+    if (coalesceCcid(ci.track, slot)) return;   // part of a burst already announced
+    if (post(Kind::Ccid, ci.track, ccid, ci.prio())) { _burst[slot].track = ci.track; _burst[slot].t = millis(); }
 
   } else if (st == 0x01) { // CLEARED
-    if (_lastCcid == ccid) _lastStatus = 0x01;
-
-    if (isSeatbeltCCID(ccid)) _S.seatbeltActive = false;
+    if (_active.clear(ccid, ci)) syncCcidMirrors();
+  }
+}
 
-    // recompute “any active” cheaply: if last status cleared, assume false until next activation
-    _S.anyCcidActive = false;
+// --- CC-ID storm coalescing: one announcement per burst of edges on the same track ---
+// The window slides: each merged edge restarts it, so a KOMBI spreading a 40-ID bulb fault over
+// several seconds still yields one clip. Four slots cover concurrent bursts on different tracks.
+// A burst opens only when its clip got past the rate limit; a refused edge must not mute the next.
+bool Filter::coalesceCcid(uint8_t track, uint8_t& slot){
+  slot = 0;
+  if (!_ccidWindowMs) return false;
+  const uint32_t now = millis();
+  slot = 0xFF;
+  for (uint8_t i = 0; i < BURST_SLOTS; i++){
+    Burst& b = _burst[i];
+    if (b.track == BURST_EMPTY){ if (slot == 0xFF || _burst[slot].track != BURST_EMPTY) slot = i; continue; }
+    if (b.track == track){
+      if ((uint32_t)(now - b.t) < _ccidWindowMs){
+        b.t = now;
+        if (_ccidMerged != 0xFFFF) _ccidMerged++;
+        return true;
+      }
+      slot = i; break;                                  // expired: reuse this slot
+    }
+    if (slot == 0xFF || (_burst[slot].track != BURST_EMPTY && (uint32_t)(now - b.t) > (uint32_t)(now - _burst[slot].t)))
+      slot = i;                                         // else an empty slot, else the oldest
   }
+  return false;
 }
 
 // --- Key / Door policies (Welcome / Goodbye / Fuel reminder) ---
@@ -96,6 +181,7 @@ void Filter::handleKeyDoor(){
   CanBus::KeyEvent kev;
   while (_can.nextKeyEvent(kev)){
     if(kev.type == CanBus::KeyEventType::Unlock){
+      _prewake        = true;
       _welcomeArmed   = true;
       _welcomeHold    = false;
       _welcomeDeadline = millis() + 120000UL; // 2 min window
@@ -118,6 +204,7 @@ void Filter::handleKeyDoor(){
       dev.type==CanBus::DoorEventType::BootOpened ||
       dev.type==CanBus::DoorEventType::BonnetOpened;
 
+    if(anyOpen) _prewake = true;
     if(passengerOpen) _S.passengerSeenSinceUnlock = true;
 
     // Welcome (high priority notification): driver door within window or held
@@ -153,89 +240,116 @@ void Filter::handleKeyDoor(){
   }
 }
 
-// --- Frame router: feed CanBus decoders, mirror state, publish edges ---
-void Filter::handleFrame(uint32_t id, uint8_t len, const uint8_t* buf){
-  // Keep CanBus internal snapshots in sync (doors, handbrake, KL15, sport, voltage, etc.)
-  _can.onFrame(id, len, buf);
-
-  // Mirror minimal car state for clients
-  _S.kl15On      = _can.kl15On();
-  _S.handbrakeUp = _can.handbrakeEngaged();
-  _S.driverDoor  = _can.doorState().driver;
-  if (_can.voltageValid()) updateVoltage(_can.lastVoltage());
-
-  // 1) CC-ID frames (project format: last 3 bytes FE FE FE)
-  if (id == ID_CCID && len>=8 && buf[5]==0xFE && buf[6]==0xFE && buf[7]==0xFE){
-    const uint16_t ccid = (uint16_t(buf[1])<<8) | buf[0];
-    const uint8_t  st   = buf[2]; // 0x02 ACTIVE, 0x01 CLEARED
-    handleCcid(ccid, st);
-    return;
-  }
+// --- Per-ID stages: each mirrors only the state its decoder owns ---
+void Filter::onCcidFrame(Filter& f, const uint8_t* buf, uint8_t){
+  // Project format: last 3 bytes FE FE FE
+  if (buf[5]!=0xFE || buf[6]!=0xFE || buf[7]!=0xFE) return;
+  const uint16_t ccid = (uint16_t(buf[1])<<8) | buf[0];
+  const uint8_t  st   = buf[2]; // 0x02 ACTIVE, 0x01 CLEARED
+  f.handleCcid(ccid, st);
+}
 
-  // 2) Sport button (ON/OFF)
-  if (id == ID_BUTTON && len >= 2){
-    const uint8_t modeByte = buf[1];
-    if (modeByte == 0xF2){ _S.sportMode = true;  postNotif(Kind::SportOn,  52); }
-    else if (modeByte == 0xF1){ _S.sportMode = false; postNotif(Kind::SportOff, 53); }
-    return;
-  }
+void Filter::onButtonFrame(Filter& f, const uint8_t* buf, uint8_t){
+  // Sport button (ON/OFF)
+  const uint8_t modeByte = buf[1];
+  if (modeByte == 0xF2){ f._S.sportMode = true;  f.postNotif(Kind::SportOn,  52); }
+  else if (modeByte == 0xF1){ f._S.sportMode = false; f.postNotif(Kind::SportOff, 53); }
+}
 
-  // 3) KL15 processing: Ignition gong + Sweep gating + handbrake warn + edge policies
-  if (id == ID_KL15 && len>=1){
-    const bool on = _can.kl15On();
+void Filter::onDoorsFrame(Filter& f, const uint8_t*, uint8_t){
+  f._S.driverDoor = f._can.doorState().driver;
+}
 
-    // Ignition gong (T13) once per KL15 cycle
-    if (on && !_ignGongPlayed){
-      postNotif(Kind::IgnGong, 13);
-      _ignGongPlayed = true;
-    } else if(!on){
-      _ignGongPlayed = false;
-    }
+void Filter::onHandbrakeFrame(Filter& f, const uint8_t*, uint8_t){
+  f._S.handbrakeUp = f._can.handbrakeEngaged();
+}
 
-    // Sweep gating: allow sweep only after we have seen KL15 OFF once since boot
-    if (!on) {
-      _sawOffSinceBoot = true;
-    } else {
-      _can.enableSweep(_sawOffSinceBoot);   // legit OFF->ON -> allow one sweep cycle
-    }
+void Filter::onVoltageFrame(Filter& f, const uint8_t*, uint8_t){
+  if (f._can.voltageValid()) f.updateVoltage(f._can.lastVoltageMv());
+}
 
-    // Edge detection for OFF/ON to arm policies
-    if (_kl15Prev && !on){
-      // KL15 just turned OFF
-      if(_lowFuelSeenWhileIgnOn){
-        _S.lowFuelRemindArmed = true;   // will play 45 on next driver door open
-        _lowFuelSeenWhileIgnOn = false;
-      }
-      _engineStopGoodbyeArmed = true;
+// KL15 processing: Ignition gong + Sweep gating + handbrake warn + edge policies
+void Filter::onKL15Frame(Filter& f, const uint8_t*, uint8_t){
+  const bool on = f._can.kl15On();
+  f._S.kl15On = on;
+
+  // Ignition gong (T13) once per KL15 cycle
+  if (on && !f._ignGongPlayed){
+    f.postNotif(Kind::IgnGong, 13);
+    f._ignGongPlayed = true;
+  } else if(!on){
+    f._ignGongPlayed = false;
+  }
 
-      // handbrake down reminder (immediate)
-      if (!_can.handbrakeEngaged()){
-        post(EvClass::SecA2, Kind::HandbrakeWarn, 50, 0, /*prio*/2);
-      }
-    } else if(!_kl15Prev && on){
-      // KL15 just turned ON -> clear goodbye/reminder arming
-      _S.lowFuelRemindArmed = false;
-      _engineStopGoodbyeArmed = false;
-      _S.passengerSeenSinceUnlock = false;
+  // Sweep gating: allow sweep only after we have seen KL15 OFF once since boot
+  if (!on) {
+    f._sawOffSinceBoot = true;
+  } else {
+    f._can.enableSweep(f._sawOffSinceBoot);   // legit OFF->ON -> allow one sweep cycle
+  }
+
+  // Edge detection for OFF/ON to arm policies
+  if (f._kl15Prev && !on){
+    // KL15 just turned OFF
+    if(f._lowFuelSeenWhileIgnOn){
+      f._S.lowFuelRemindArmed = true;   // will play 45 on next driver door open
+      f._lowFuelSeenWhileIgnOn = false;
     }
-    _kl15Prev = on;
+    f._engineStopGoodbyeArmed = true;
 
-    return;
+    // handbrake down reminder (immediate)
+    if (!f._can.handbrakeEngaged()){
+      f.post(Kind::HandbrakeWarn, 50, 0, /*prio A2*/2);
+    }
+  } else if(!f._kl15Prev && on){
+    f._prewake = true;   // ignition gong follows
+    // KL15 just turned ON -> clear goodbye/reminder arming
+    f._S.lowFuelRemindArmed = false;
+    f._engineStopGoodbyeArmed = false;
+    f._S.passengerSeenSinceUnlock = false;
   }
+  f._kl15Prev = on;
+}
 
-  // 4) Voltage/engine state on 0x3B4 handled in CanBus::onFrame -> mirrored above
+// --- Frame router: CanBus decodes (one route), then the slot's Filter stage runs ---
+void Filter::handleFrame(uint32_t id, uint8_t len, const uint8_t* buf){
+  static constexpr Stage kStages[] PROGMEM = {   // CAN_SUBSCRIBED_IDS order
+    { ID_CCID,       onCcidFrame      },
+    { ID_KEYBTN,     nullptr          },   // key events consumed in handleKeyDoor()
+    { ID_DOORS2,     onDoorsFrame     },
+    { ID_KL15,       onKL15Frame      },
+    { ID_BUTTON,     onButtonFrame    },
+    { ID_HANDBRAKE,  onHandbrakeFrame },
+    { ID_AIRBAG,     nullptr          },
+    { ID_BATT_CHECK, onVoltageFrame   },
+  };
+  static_assert(CanIds::inSlotOrder(kStages), "Filter::handleFrame stages out of CAN_SUBSCRIBED_IDS order");
+
+  const uint8_t slot = _can.onFrame(id, len, buf);   // DLC-gated decoder, if any
+  if (slot == CanIds::NO_SLOT) return;
+  const StageFn fn = (StageFn)pgm_read_ptr(&kStages[slot].fn);
+  if (!fn) return;
+  LatTrace::frameStage(LatTrace::HANDLE);
+  fn(*this, buf, len);
 }
 
 // --- Pump CAN + process policies + run KOMBI sweep machine ---
 void Filter::tick(){
   uint32_t id; uint8_t len; uint8_t buf[8];
+  _can.rxWatchdog();
   while (_can.readOnceDistinct(id, len, buf)) {
     handleFrame(id, len, buf);
+    LatTrace::frameEnd();
   }
 
+  _can.pollErrors();
+
   // Consume key/door streams to generate Welcome/Goodbye/Fuel intents
   handleKeyDoor();
+  rateRefill();
 
-  // KOMBI sweep state machine
+  // KOMBI sweep state machine (queues its bursts) + bench load + timed TX drain
   _can.tickSweep();
+  _can.tickBench();
+  _can.tickTx();
 }
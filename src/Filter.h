@@ -1,7 +1,7 @@
 #pragma once
 #include <Arduino.h>
 #include "CanBus.h"
-#include "CCIDMap.h"   // trackForCcid(), isSeatbeltCCID(), isLowFuelCCID()
+#include "CCIDMap.h"   // Ccid::lookup(), trackForCcid(), isSeatbeltCCID()
 
 class Filter {
 public:
@@ -13,8 +13,14 @@ public:
   // Call every loop: drains CAN, updates state, processes key/door policies, runs KOMBI sweep.
   void tick();
 
-  // Optional threshold for battery low (volts)
-  void setBatteryLowVolt(float v) { _batLow = v; }
+  // Optional threshold for battery low (millivolts)
+  void setBatteryLowMv(uint16_t mv) { _batLowMv = mv; }
+
+  // CC-ID storm coalescing: an ACTIVE edge whose track was announced (or merged) less than this
+  // ago is folded into that announcement — 40 bulb IDs on T24, tyre 139+608 -> one clip. 0: off.
+  static const uint16_t CCID_COALESCE_MS = 2000;
+  void setCcidCoalesceMs(uint16_t ms) { _ccidWindowMs = ms; }
+  uint16_t ccidCoalesced() const { return _ccidMerged; }   // edges merged into a burst
 
   // === Read-only snapshot ===
   struct CarState {
@@ -22,15 +28,15 @@ public:
     bool    driverDoor  = false;
     bool    handbrakeUp = true;
 
-    float   batteryV    = NAN;    // last 0x3B4 volts
-    bool    batteryLow  = false;  // derived vs _batLow
+    uint16_t batteryMv  = 0;      // last 0x3B4 millivolts (0 = not seen yet)
+    bool    batteryLow  = false;  // derived vs _batLowMv
 
-    bool    seatbeltActive = false;       // from CC-ID seatbelt
+    bool    seatbeltActive = false;       // any seatbelt CC-ID active
     bool    sportMode      = false;       // from 0x315 F2/F1
     bool    passengerSeenSinceUnlock = false;
 
     bool    lowFuelRemindArmed = false;   // will fire once on next driver door (Filter emits the intent)
-    bool    anyCcidActive = false;        // convenience for “is something alarming active?”
+    bool    anyCcidActive = false;        // at least one CC-ID ACTIVE (Filter::activeCcids())
   };
   const CarState& state() const { return _S; }
 
@@ -39,52 +45,110 @@ public:
     Ccid, SportOn, SportOff, IgnGong, HandbrakeWarn,
     FuelReminder, Welcome, Goodbye
   };
+  static const uint8_t KINDS = 8;
   struct PlayIntent {
     Kind     kind;
     uint16_t track;     // DFPlayer track to play (already mapped)
     uint16_t ccid;      // for Kind::Ccid; otherwise 0
     uint8_t  prio;      // 3=A1, 2=A2, 1=A3, 0=Notif
     uint32_t t_ms;
+    uint8_t  trace;     // LatTrace id (LatTrace::NONE when not posted from a frame)
   };
 
-  // Two queues: Security (A1/A2/A3) and Notification (A4+B+Welcome/Goodbye)
-  bool popSecurity(PlayIntent& out)     { return _secQ.pop(out); }
-  bool popNotification(PlayIntent& out) { return _notQ.pop(out); }
+  // Per-track token bucket, checked before anything is queued: a track may play `burst` times
+  // back to back, then once per `refillS` seconds (limits by the intent's Kind, bucket by track).
+  // A flapping door switch or info CC-ID cannot keep the DF cycling. A1/A2 (brake, airbag, engine
+  // stop, handbrake) are never throttled: a warning that re-asserts is spoken. refillS 0: unlimited.
+  struct RateLimit { uint8_t burst, refillS; };            // burst * refillS <= 255
+  void setRateLimit(Kind k, uint8_t burst, uint8_t refillS);
+  uint16_t rateLimited() const { return _rateRejected; }  // intents refused by a bucket
+
+  // ===== Intent scheduler: one bounded queue for every play-intent =====
+  // Best first: highest effective prio, FIFO within a level. A notification (or A3) gains one level
+  // per AGE_STEP_MS it waits, up to AGE_CAP, so a stream of A3s cannot starve it; A1 always leads.
+  // A track already queued is coalesced into that entry (keeps its place, takes the higher prio).
+  // Full: the new intent evicts the lowest-ranked, newest entry if it outranks it, else it is dropped.
+  static const uint8_t  INTENT_CAP  = 24;
+  static const uint16_t AGE_STEP_MS = 8000;
+  static const uint8_t  AGE_CAP     = 2;           // aged entries rank at most as A2
+  struct SchedStats { uint16_t posted, coalesced, evicted, dropped, aged; uint8_t peak; };
+
+  const PlayIntent* peekIntent(uint32_t now) const { return _q.peek(now); }   // nullptr: empty
+  bool popIntent(PlayIntent& out, uint32_t now)     { return _q.pop(out, now); }
+  uint8_t intentsPending() const                    { return _q.n; }
+  const SchedStats& schedStats() const              { return _q.st; }
 
   // You may still want key/door streams for radio policy in Device:
   bool nextKeyEvent(CanBus::KeyEvent& e)  { return _can.nextKeyEvent(e); }
   bool nextDoorEvent(CanBus::DoorEvent& e){ return _can.nextDoorEvent(e); }
 
+  // Leading indicator for audio soon (Unlock, door-open edge, KL15 rising edge); one-shot
+  bool takePrewake() { const bool p = _prewake; _prewake = false; return p; }
+
+  // KOMBI sweep running or its frames still queued
+  bool sweepActive() const { return _can.sweepActive(); }
+
+  // Frames lost because the ISR-fed RX ring was full
+  uint16_t canRxOverflows() const { return _can.rxOverflows(); }
+
+  // CC-IDs currently ACTIVE on the KOMBI (per-class counts)
+  const Ccid::ActiveSet& activeCcids() const { return _active; }
+
+  // Bus statistics (per-ID counters, gap min/avg/max, EFLG events, TX results)
+  const CanBus& can() const { return _can; }
+  void resetCanStats() { _can.resetStats(); }
+
+  // Loopback bench load (CanBus::benchStart): the car bus is not seen while it runs
+  bool startCanBench(uint16_t fps) { return _can.benchStart(fps); }
+  void stopCanBench() { _can.benchStop(); }
+
 private:
-  // ===== tiny ring queue =====
-  template<size_t CAP>
-  struct RQ {
-    PlayIntent q[CAP]; uint8_t w=0, r=0;
-    bool push(const PlayIntent& e){ uint8_t n=(uint8_t)(w+1u)%CAP; if(n==r) return false; q[w]=e; w=n; return true; }
-    bool pop(PlayIntent& e){ if(r==w) return false; e=q[r]; r=(uint8_t)(r+1u)%CAP; return true; }
+  // Intents in arrival order (removal shifts down), so the first of equal rank is the oldest
+  struct IntentQueue {
+    PlayIntent q[INTENT_CAP]; uint8_t n = 0;
+    SchedStats st = {};
+    static uint8_t rank(const PlayIntent& e, uint32_t now);
+    int8_t best(uint32_t now) const;
+    const PlayIntent* peek(uint32_t now) const { const int8_t i = best(now); return i < 0 ? nullptr : &q[i]; }
+    PlayIntent* push(const PlayIntent& e);   // the new entry; nullptr when merged or dropped
+    bool pop(PlayIntent& out, uint32_t now);
+    void removeAt(uint8_t i);
   };
 
-  // Security classes
-  enum class EvClass : uint8_t { SecA1=3, SecA2=2, SecA3=1, Notif=0 };
-  static EvClass classifyCcid(uint16_t ccid, uint8_t& prio);
-
   // Internals
   void handleFrame(uint32_t id, uint8_t len, const uint8_t* buf);
+
+  // Per-ID stages (slot-indexed, see handleFrame); run after CanBus decoded the frame
+  typedef void (*StageFn)(Filter&, const uint8_t*, uint8_t);
+  struct Stage { uint16_t id; StageFn fn; };
+  static void onCcidFrame(Filter& f, const uint8_t* buf, uint8_t len);
+  static void onButtonFrame(Filter& f, const uint8_t* buf, uint8_t len);
+  static void onDoorsFrame(Filter& f, const uint8_t* buf, uint8_t len);
+  static void onHandbrakeFrame(Filter& f, const uint8_t* buf, uint8_t len);
+  static void onVoltageFrame(Filter& f, const uint8_t* buf, uint8_t len);
+  static void onKL15Frame(Filter& f, const uint8_t* buf, uint8_t len);
   void handleCcid(uint16_t ccid, uint8_t st);
+  bool coalesceCcid(uint8_t track, uint8_t& slot);   // true: same track announced within the window;
+                                                     // false: slot to record once the clip is posted
+  void syncCcidMirrors(){ _S.anyCcidActive = _active.count() != 0; _S.seatbeltActive = _active.seatbelts() != 0; }
   void handleKeyDoor();                 // NEW: welcome/goodbye/fuel reminder here
-  void post(EvClass cls, Kind k, uint16_t track, uint16_t ccid=0, uint8_t prio=0);
-  void postNotif(Kind k, uint16_t track){ post(EvClass::Notif, k, track); }
-  void updateVoltage(float v);
+  bool post(Kind k, uint16_t track, uint16_t ccid=0, uint8_t prio=0);   // false: rate limited
+  static const uint8_t RATE_EXEMPT_PRIO = 2;   // prio >= this (A2, A1) bypasses the buckets
+  bool rateAllow(Kind k, uint16_t track, uint8_t prio);
+  void rateRefill();
+  void postNotif(Kind k, uint16_t track){ post(k, track); }
+  void updateVoltage(uint16_t mv);
 
   // members
   CanBus   _can;
   CarState _S;
-  float    _batLow = 11.8f;
+  uint16_t _batLowMv = 11800;
 
   // sweep gating / ignition gong
   bool     _ignGongPlayed   = false;   // once per KL15 cycle
   bool     _sawOffSinceBoot = false;   // sweep only after real OFF->ON
   bool     _kl15Prev        = false;
+  bool     _prewake         = false;
 
   // welcome/goodbye/fuel
   bool     _welcomeArmed = false;
@@ -93,11 +157,34 @@ private:
   bool     _engineStopGoodbyeArmed = false;
   bool     _lowFuelSeenWhileIgnOn  = false;
 
-  // CCID debounce + mirrors
-  uint16_t _lastCcid = 0;
-  uint8_t  _lastStatus = 0;   // 0x02 active, 0x01 cleared
+  // CC-ID activation state: each ID announces once per ACTIVE edge
+  Ccid::ActiveSet _active;
+  bool     _okArmed = false;  // something went ACTIVE since the last "all OK"
+
+  // storm coalescing: last announced tracks; a merge restarts the slot's window
+  static const uint8_t BURST_SLOTS = 4;
+  static const uint8_t BURST_EMPTY = 0xFF;   // slot never used (no track is 255)
+  struct Burst { uint8_t track; uint32_t t; };
+  Burst    _burst[BURST_SLOTS] = { { BURST_EMPTY, 0 }, { BURST_EMPTY, 0 }, { BURST_EMPTY, 0 }, { BURST_EMPTY, 0 } };
+  static_assert(BURST_SLOTS == 4, "Filter: _burst initialiser lists BURST_SLOTS empty slots");
+  uint16_t _ccidWindowMs = CCID_COALESCE_MS;
+  uint16_t _ccidMerged = 0;
+
+  // rate limiting: one credit byte per track, +1 per second (saturating); a play costs refillS
+  // credits and the bucket holds burst * refillS, so the check is O(1) and the refill one pass/s
+  RateLimit _rate[KINDS] = {
+    { 2, 10 },   // Ccid           A3/info flapping ACTIVE/CLEARED: twice, then every 10 s
+    { 3,  5 },   // SportOn
+    { 3,  5 },   // SportOff
+    { 2, 10 },   // IgnGong
+    { 2, 10 },   // HandbrakeWarn  (posted as A2: exempt unless its prio is lowered)
+    { 1, 60 },   // FuelReminder
+    { 1, 60 },   // Welcome        door bouncing on 0x2FC
+    { 1, 30 },   // Goodbye
+  };
+  uint8_t  _credit[DF_MAX_MP3 + 1];
+  uint32_t _rateT = 0;
+  uint16_t _rateRejected = 0;
 
-  // queues
-  RQ<24> _secQ;   // A1/A2/A3
-  RQ<32> _notQ;   // A4 + B + Welcome/Goodbye
+  IntentQueue _q;
 };
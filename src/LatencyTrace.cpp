@@ -0,0 +1,76 @@
+#include "LatencyTrace.h"
+
+#if LATENCY_TRACE
+namespace LatTrace {
+
+// Stamps are offsets from t0 (the RX time) in UNIT_US steps; d[s-1] belongs to stage s.
+struct Entry   { uint8_t id; uint8_t prio; uint32_t t0; uint16_t d[STAGES - 1]; };
+struct Scratch { bool live; uint32_t t0; uint16_t d[HANDLE]; };   // ACCEPT, HANDLE
+
+static Entry   s_ring[TRACE_CAP];
+static Scratch s_frame  = { false, 0, { UNREACHED, UNREACHED } };
+static uint8_t s_nextId = 1;
+static uint8_t s_active = NONE;
+
+static uint16_t since(uint32_t t0){
+  const uint32_t u = (micros() - t0) / UNIT_US;
+  return u >= UNREACHED ? (uint16_t)(UNREACHED - 1) : (uint16_t)u;
+}
+
+void frame(uint32_t rxUs){
+  s_frame.live = true; s_frame.t0 = rxUs;
+  for(uint8_t i=0;i<HANDLE;i++) s_frame.d[i] = UNREACHED;
+}
+void frameStage(Stage s){
+  if(s_frame.live && s >= ACCEPT && s <= HANDLE && s_frame.d[s - 1] == UNREACHED) s_frame.d[s - 1] = since(s_frame.t0);
+}
+void frameEnd(){ s_frame.live = false; }
+
+uint8_t open(uint8_t prio){
+  if(!s_frame.live) return NONE;            // key/door policies etc.: no RX time to measure from
+  const uint8_t id = s_nextId;
+  s_nextId = (uint8_t)(s_nextId == 0xFF ? 1 : s_nextId + 1);
+  Entry &e = s_ring[id & (TRACE_CAP - 1)];
+  e.id = id; e.prio = prio; e.t0 = s_frame.t0;
+  for(uint8_t i=0;i<STAGES - 1;i++) e.d[i] = (i < HANDLE) ? s_frame.d[i] : UNREACHED;
+  e.d[POST - 1] = since(e.t0);
+  return id;
+}
+void mark(uint8_t id, Stage s){
+  if(id == NONE || s == RX) return;
+  Entry &e = s_ring[id & (TRACE_CAP - 1)];
+  if(e.id != id || e.d[s - 1] != UNREACHED) return;   // overwritten by a newer intent / already stamped
+  e.d[s - 1] = since(e.t0);
+}
+void cancel(uint8_t id){
+  if(id == NONE) return;
+  Entry &e = s_ring[id & (TRACE_CAP - 1)];
+  if(e.id == id) e.id = NONE;
+}
+void setActive(uint8_t id){ s_active = id; }
+void markActive(Stage s){ mark(s_active, s); }
+
+bool percentileUs(Stage s, uint8_t pct, uint8_t minPrio, uint32_t& outUs, uint8_t& samples){
+  uint16_t v[TRACE_CAP]; uint8_t n = 0;
+  for(uint8_t i=0;i<TRACE_CAP;i++){
+    const Entry &e = s_ring[i];
+    if(e.id == NONE || e.prio < minPrio) continue;
+    const uint16_t d = (s == RX) ? 0 : e.d[s - 1];
+    if(d == UNREACHED) continue;
+    uint8_t k = n++;                         // insertion sort, at most TRACE_CAP items
+    while(k > 0 && v[k - 1] > d){ v[k] = v[k - 1]; k--; }
+    v[k] = d;
+  }
+  samples = n;
+  if(!n) return false;
+  const uint8_t idx = (uint8_t)(((uint16_t)pct * (n - 1) + 50) / 100);   // nearest rank
+  outUs = (uint32_t)v[idx] * UNIT_US;
+  return true;
+}
+void reset(){
+  for(uint8_t i=0;i<TRACE_CAP;i++) s_ring[i].id = NONE;
+  s_active = NONE;
+}
+
+} // namespace LatTrace
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+#include <Arduino.h>
+
+// ===== End-to-end latency trace: CAN frame -> play-intent -> DFPlayer audible =====
+// Every intent posted while a frame is being handled gets a trace id; each stage stamps
+// micros() against the frame's RX time (taken in the RX ISR). The last TRACE_CAP intents are
+// kept, so the CLI can print per-stage percentiles over recent traffic.
+// Off by default (the ring and scratch cost ~170 B of a 2 KB part): every hook compiles to
+// nothing. Build the nanoatmega328_trace env (-DLATENCY_TRACE=1) to measure.
+#ifndef LATENCY_TRACE
+#define LATENCY_TRACE 0
+#endif
+
+namespace LatTrace {
+
+enum Stage : uint8_t {
+  RX,         // frame pulled out of the MCP2515 (ISR timestamp) — t0 of the trace
+  ACCEPT,     // passed the de-dup window
+  HANDLE,     // Filter stage for the frame's ID entered (handleCcid for 0x338)
+  POST,       // intent queued by Filter::post
+  POP,        // Device popped the intent
+  PLAY_CMD,   // PLAY (0x12) written to the DFPlayer
+  BUSY_LOW,   // DFPlayer BUSY went LOW (playing)
+  RELAY_ON,   // speaker relay closed: audible
+  STAGES
+};
+
+static const uint8_t  NONE      = 0;       // "not traced" id
+static const uint8_t  TRACE_CAP = 8;       // power of two
+static const uint16_t UNIT_US   = 64;      // stamp resolution; 16-bit stamps reach ~4 s (DF cold boot)
+static const uint16_t UNREACHED = 0xFFFF;
+
+#if LATENCY_TRACE
+// Frame scope (Filter::tick): stamps land in a scratch record until an intent claims it
+void frame(uint32_t rxUs);
+void frameStage(Stage s);
+void frameEnd();
+
+// Intent scope
+uint8_t open(uint8_t prio);            // Filter::post: claims the frame scratch; NONE outside a frame
+void    mark(uint8_t id, Stage s);     // first stamp per stage wins
+void    cancel(uint8_t id);            // intent evicted before POP: drop its record
+void    setActive(uint8_t id);         // intent the Player is working on (PLAY/BUSY/relay stamps)
+void    markActive(Stage s);
+
+// Read-out: latency RX -> stage over the kept intents with prio >= minPrio
+// pct 0..100; returns false when no sample reached the stage.
+bool    percentileUs(Stage s, uint8_t pct, uint8_t minPrio, uint32_t& outUs, uint8_t& samples);
+void    reset();
+#else
+inline void    frame(uint32_t) {}
+inline void    frameStage(Stage) {}
+inline void    frameEnd() {}
+inline uint8_t open(uint8_t) { return NONE; }
+inline void    mark(uint8_t, Stage) {}
+inline void    cancel(uint8_t) {}
+inline void    setActive(uint8_t) {}
+inline void    markActive(Stage) {}
+inline bool    percentileUs(Stage, uint8_t, uint8_t, uint32_t&, uint8_t& n) { n = 0; return false; }
+inline void    reset() {}
+#endif
+
+} // namespace LatTrace
@@ -12,6 +12,18 @@
 #define PIN_DF_EN     7   // MOSFET gate controlling DF power (HIGH = ON)
 #define PIN_RADIO_HOLD 9  // Keeps radio powered
 
+// DFPlayer link transport (DfLink.h)
+//   SOFTSERIAL: SoftwareSerial on D4/D3, CLI on USB Serial (default)
+//   HWSERIAL:   hardware USART D0/D1 to the DF; CLI becomes a TX-only debug channel on D3
+//   TIMER_TX:   Timer2 OC2B UART on D3, TX only (no DF replies); CLI stays on USB Serial
+#define DF_LINK_SOFTSERIAL 0
+#define DF_LINK_HWSERIAL   1
+#define DF_LINK_TIMER_TX   2
+#ifndef DF_LINK
+#define DF_LINK DF_LINK_SOFTSERIAL
+#endif
+#define PIN_DBG_TX    3   // DF_LINK_HWSERIAL: debug TX on the pin the DF link gave up (OC2B)
+
 // Speaker / Amplifier relay (pop control)
 #define PIN_SPK_RELAY 6   // HIGH = relay ON (speaker connected)
 
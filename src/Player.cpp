@@ -4,8 +4,32 @@
 inline bool Player::elapsedSince(uint32_t start_ms, uint32_t ms) {
   return (uint32_t)(millis() - start_ms) >= ms;
 }
-
-Player::Player() : _ss(PIN_DF_RX, PIN_DF_TX) {}
+bool Player::inStateFor(uint16_t ms) const { return elapsedSince(_stT0, ms); }
+
+Player::Player() {}
+
+// ---- BUSY edges (ISR) ----
+// SoftwareSerial owns PCINT2 (D4..D7), so with it BUSY is sampled from the Timer0 compare-A
+// tick (~1 kHz, beside CanBus's compare-B); other DF links take the D5 pin-change interrupt.
+static volatile uint8_t* s_busyPort = nullptr;
+static uint8_t           s_busyMask = 0;
+static volatile uint8_t  s_busyHigh = 1;          // HIGH = idle
+static volatile uint8_t  s_busyRises = 0;
+static volatile uint32_t s_busyRiseMs = 0;
+
+#if DF_LINK == DF_LINK_SOFTSERIAL
+ISR(TIMER0_COMPA_vect){ Player::isrBusy(); }
+#else
+ISR(PCINT2_vect){ Player::isrBusy(); }            // D5 = PCINT21 (port D group)
+#endif
+
+void Player::isrBusy() {
+  if (!s_busyPort) return;
+  const uint8_t high = (*s_busyPort & s_busyMask) ? 1 : 0;
+  if (high == s_busyHigh) return;
+  s_busyHigh = high;
+  if (high) { s_busyRises++; s_busyRiseMs = millis(); }
+}
 
 void Player::begin() {
   pinMode(PIN_DF_EN, OUTPUT);
@@ -16,12 +40,26 @@ void Player::begin() {
   digitalWrite(PIN_SPK_RELAY, LOW);  _relayOn   = false;
   digitalWrite(PIN_DF_EN, LOW);      _dfPowered = false;
 
-  _playing = false;
   _currentTrack = 0;
   _lastActiveMs = millis();
-
-  // Serial will be (re)started in ensureReady()
-  _ss.end();
+  enter(State::Off);
+
+  s_busyPort = portInputRegister(digitalPinToPort(PIN_DF_BUSY));
+  s_busyMask = digitalPinToBitMask(PIN_DF_BUSY);
+  s_busyHigh = (*s_busyPort & s_busyMask) ? 1 : 0;
+#if DF_LINK == DF_LINK_SOFTSERIAL
+  OCR0A = 0x40;               // away from CanBus's OCR0B phase
+  TIMSK0 |= _BV(OCIE0A);
+#else
+  *digitalPinToPCMSK(PIN_DF_BUSY) |= _BV(digitalPinToPCMSKbit(PIN_DF_BUSY));
+  *digitalPinToPCICR(PIN_DF_BUSY) |= _BV(digitalPinToPCICRbit(PIN_DF_BUSY));
+#endif
+
+  EEPROM.get(EE_BOOT_ADDR, _boot);
+  if (_boot.magic != EE_BOOT_MAGIC) resetBootLearn();
+
+  // Link will be (re)started in openLink()
+  DfLink::close();
 }
 
 // ----- Volume -----
@@ -29,198 +67,484 @@ void Player::setVolume(uint8_t v) {
   if (v > DF_VOLUME_MAX) v = DF_VOLUME_MAX;
   _volume = v;
 
-  // If awake, apply immediately; otherwise it will be applied on next ensureReady()
-  if (_dfPowered) {
-    _df.setVolume(_volume);
-    pumpDF(50);
+  // If the DF is up and listening, apply now; otherwise SettingVolume applies it on the next start
+  if ((_st == State::Idle || _st == State::Playing) && applySetting(_shadow.volume, _volume, 0x06))
     _lastActiveMs = millis();
-  }
 }
 
-// ----- Power / readiness sequence -----
+void Player::setEQ(DFPMini::EQ eq) {
+  _eq = (eq > DFPMini::EQ_BASS) ? (uint8_t)DFPMini::EQ_BASS : (uint8_t)eq;
+  if (_st == State::Idle || _st == State::Playing) (void)applySetting(_shadow.eq, _eq, 0x07);
+}
+
+bool Player::applySetting(uint8_t& shadowed, uint8_t want, uint8_t cmd) {
+  if (want == UNKNOWN || shadowed == want) return false;
+  if (!_df.enqueue(cmd, want)) return false;
+  shadowed = want;            // a command that finally fails invalidates the shadow (loop)
+  return true;
+}
+
+void Player::verifyShadow() {
+  if (!_dfPowered || _st == State::Standby || _st == State::Off) return;
+  _df.queryVolume();
+  _df.queryEQ();
+  _df.queryPlayMode();
+}
+
+// ----- Power / link -----
 void Player::powerOnDF() {
   digitalWrite(PIN_DF_EN, HIGH);
   _dfPowered = true;
-  delay(DF_WAKE_MS);            // let power rails & DF core stabilize
-  _lastActiveMs = millis();
+  _powerOnMs = _lastActiveMs = millis();
+  openLink();                 // listen from the start: EV_INIT marks the end of the DF boot
+  _sawInit = false;
 }
 
 void Player::powerOffDF() {
   if (!_dfPowered) return;
-
-  // Always open relay first to avoid pop
-  delay(AMP_PRE_OFF_MS);
-  relayOff();
-
+  relayOff();                 // relay is always opened before DF power drops
   digitalWrite(PIN_DF_EN, LOW);
+  _df.clearPipeline();
+  invalidateShadow();
   _dfPowered = false;
 }
 
-bool Player::ensureReady() {
-  bool coldBoot = false;
+void Player::openLink() {
+  DfLink::open();
+  _df.begin(DfLink::port(), PIN_DF_BUSY, true, DfLink::DUPLEX); // BUSY active LOW on typical DF mini
+}
 
-  if (!_dfPowered) {
-    // We are coming from sleep → reconnect fully
-    powerOnDF();
-    coldBoot = true;
-  }
+// ----- Boot-time learning -----
+void Player::resetBootLearn() {
+  const BootPhase empty = { 0, 0xFFFF, 0, 0 };
+  _boot.magic = EE_BOOT_MAGIC;
+  _boot.init = empty; _boot.ready = empty;
+  EEPROM.put(EE_BOOT_ADDR, _boot);
+}
 
-  // Hard (re)start serial each time to avoid stale state after sleep
-  _ss.end();
-  _ss.begin(9600);
-  delay(10);
+void Player::learn(BootPhase& p, uint16_t ms) {
+  if (ms < p.minMs) p.minMs = ms;
+  if (ms > p.maxMs) p.maxMs = ms;
+  if (p.n < 0xFF) p.n++;
+  const uint8_t w = p.n < 8 ? p.n : 8;            // plain mean first, then EWMA
+  p.avgMs = (uint16_t)((int32_t)p.avgMs + ((int32_t)ms - (int32_t)p.avgMs) / w);
+}
+
+static bool within(uint16_t a, uint16_t b, uint16_t tol) { return (a > b ? a - b : b - a) <= tol; }
 
-  // (Re)initialise DFPMini driver against our serial and BUSY pin
-  _df.begin(_ss, PIN_DF_BUSY, true); // BUSY active LOW on typical DF mini
+// Plain-mean phase (n < 8) always counts: the weights of the next samples depend on n
+bool Player::drifted(const BootPhase& saved, const BootPhase& now) {
+  if (saved.n < 8 && saved.n != now.n) return true;
+  return !within(saved.minMs, now.minMs, BOOT_SAVE_TOL_MS) || !within(saved.avgMs, now.avgMs, BOOT_SAVE_TOL_MS)
+      || !within(saved.maxMs, now.maxMs, BOOT_SAVE_TOL_MS);
+}
 
-  if (coldBoot) {
-    // Send RESET right after power-up; let it internally reinit & scan media
-    _df.reset(false);
-    pumpDF(DF_POST_RESET_MS);
+void Player::saveBootLearn() {
+  _bootDirty = false;
+  BootLearn saved;
+  EEPROM.get(EE_BOOT_ADDR, saved);
+  if (saved.magic == EE_BOOT_MAGIC && !drifted(saved.init, _boot.init) && !drifted(saved.ready, _boot.ready)) return;
+  EEPROM.put(EE_BOOT_ADDR, _boot);   // byte-wise update: only changed cells are written
+}
 
-    // Ensure source is TF
-    _df.setSource(DFPMini::SRC_TF, false);
-    pumpDF(50);
+// Without EV_INIT, move on once this module is known to have booted (max seen + 25%)
+uint16_t Player::wakeBoundMs() const {
+  if (_boot.init.n < 3) return DF_WAKE_MS;
+  const uint32_t b = (uint32_t)_boot.init.maxMs + _boot.init.maxMs / 4 + 20;
+  return b < DF_WAKE_MS ? (uint16_t)b : DF_WAKE_MS;
+}
 
-    // Wait until DF reports "idle/ready": BUSY must be HIGH (not playing)
-    if (!waitForDFReady(DF_READY_TIMEOUT_MS)) {
-      return false;
-    }
+// ----- State machine -----
+void Player::enter(State s) {
+  _st = s;
+  _stT0 = millis();
+  _step = 0;
+}
+
+void Player::startSequence() {
+  relayOff();                 // path quiet before starting anything new
+  _retried = false;
+  if (_health != Health::Healthy && _dfPowered) {
+    powerOffDF();             // recovery: a hung module only comes back through a power cycle
+    enter(State::Recovering);
+    return;
+  }
+  _cold = !_dfPowered;
+  if (_st == State::Standby) {
+    _df.enqueue(0x0B, 0);     // NORMAL: leave standby; serial link is still up
+    enter(State::Waking);
+  } else if (_cold) {
+    powerOnDF();
+    enter(State::Powering);
   } else {
-    // If not a cold boot, still ensure we're idle before issuing new commands
-    (void)waitBusyLevel(HIGH, 500);
+    enter(State::WaitingReady); // warm: the link stays open, commands already queued still go out
   }
+}
 
-  // IMPORTANT: Apply volume after any reset or reattach (before any playback).
-  // Some DF clones drop the first state command after reset; send twice with spacing.
-  _df.setVolume(_volume);
-  pumpDF(80);
-  _df.setVolume(_volume);
-  pumpDF(80);
-  return true;
+void Player::failPlay() {
+  // Not playing — bail out without engaging the relay
+  _finished = _currentTrack;
+  _currentTrack = 0;
+  _loop = false;
+  _seqCount = 0;
+  _reqTier = 0xFF;
+  relayOff();
+  enter(State::Idle);
+  noteFailure();
+}
+
+// ----- Circuit breaker -----
+void Player::noteHealthy() {
+  _consecFails = 0;
+  _probing = false;
+  if (_health != Health::Healthy) _brk.recoveries++;
+  _health = Health::Healthy;
+  _backoffMs = 0;
 }
 
-// Wait for BUSY to a specific logic level
-bool Player::waitBusyLevel(int level, uint16_t timeout_ms) {
-  const uint32_t t0 = millis();
-  while (!elapsedSince(t0, timeout_ms)) {
-    if (digitalRead(PIN_DF_BUSY) == level) return true;
-    pumpDF(2);
+void Player::noteFailure() {
+  _brk.failures++;
+  if (_consecFails < 0xFF) _consecFails++;
+  if (_health == Health::Open || _consecFails >= BREAKER_TRIP_FAILS) {
+    if (_health != Health::Open) { _brk.trips++; _backoffMs = BREAKER_BASE_MS; }
+    else if (_probing) _backoffMs = (_backoffMs * 2 > BREAKER_MAX_MS) ? BREAKER_MAX_MS : _backoffMs * 2;
+    _health = Health::Open;
+    _probing = false;
+    _openMs = millis();
+    _seqCount = 0;
+    powerOffDF();             // nothing talks to the module until the probe
+    enter(State::Off);
+  } else {
+    _health = Health::Degraded;
   }
-  return (digitalRead(PIN_DF_BUSY) == level);
 }
 
-// Wait for DF mini to be "ready": BUSY HIGH and/or init/device-in events observed
-bool Player::waitForDFReady(uint16_t timeout_ms) {
-  const uint32_t t0 = millis();
-  bool sawInitOrDevice = false;
+void Player::startProbe() {
+  _probing = true;
+  _brk.probes++;
+  const bool fresh = _heldTrack && !elapsedSince(_heldMs, BREAKER_HOLD_MS);
+  _currentTrack = fresh ? _heldTrack : 0;          // no track: bring-up alone is the test
+  _loop = fresh && _heldLoop;
+  _heldTrack = 0;
+  _seqCount = 0;
+  _reqTier = 0xFF;
+  _lastActiveMs = millis();
+  startSequence();
+}
 
-  while (!elapsedSince(t0, timeout_ms)) {
-    // BUSY HIGH means idle/ready
-    if (digitalRead(PIN_DF_BUSY) == HIGH) return true;
+void Player::finishTrack() {
+  _finDup = 0;
+  _finished = _currentTrack;
+  _currentTrack = 0;
+  _loop = false;
+  _df.enqueue(0x16, 0);       // logical stop; no need to power off immediately
+  enter(State::Stopping);
+}
 
-    // Parse inbound frames and look for EV_INIT/EV_DEVICE_IN
-    _df.update();
-    while (_df.available()) {
-      auto ev = _df.readEvent();
-      if (ev.type == DFPMini::EV_INIT || ev.type == DFPMini::EV_DEVICE_IN) {
-        sawInitOrDevice = true;
-      }
-    }
-    delay(2);
-  }
+void Player::chainNext() {
+  _finDup = _currentTrack;    // the DF may repeat this clip's TF_FIN
+  _currentTrack = _seq[0];
+  _seqCount--;
+  for (uint8_t i = 0; i < _seqCount; i++) _seq[i] = _seq[i + 1];
+  _retried = false;
+  _reqTier = 0xFF;            // not a request latency: the DF is warm and the relay closed
+  _lastActiveMs = millis();
+  _df.enqueue(0x12, _currentTrack);   // module already at volume/EQ; PLAY is the only frame
+  LatTrace::markActive(LatTrace::PLAY_CMD);
+  notePlaySent();
+  enter(State::Confirming);
+}
 
-  // If we saw init/device but BUSY never turned HIGH, try one last BUSY read
-  if (sawInitOrDevice) return (digitalRead(PIN_DF_BUSY) == HIGH);
-  return false;
+// BUSY may still be LOW from the clip before (chained on TF_FIN): its late rise must neither
+// confirm this PLAY nor end it. Rises counted so far are that clip's. The retry STOPs first,
+// so a LOW after it is ours even if BUSY never read HIGH.
+void Player::notePlaySent() {
+  _busyRisesSeen = s_busyRises;
+  _playSawIdle = s_busyHigh || _retried;
 }
 
-// Parse inbound frames for a bit while waiting (keeps command pipeline healthy)
-void Player::pumpDF(uint16_t ms) {
-  const uint32_t t0 = millis();
-  while (!elapsedSince(t0, ms)) {
-    _df.update();
-    while (_df.available()) (void)_df.readEvent();
-    delay(2);
-  }
+bool Player::requestSequence(const uint16_t* tracks, uint8_t n) {
+  if (!n) return false;
+  if (n > SEQ_MAX + 1) n = SEQ_MAX + 1;
+  if (!requestPlay(tracks[0])) return false;
+  for (uint8_t i = 1; i < n; i++) (void)appendToSequence(tracks[i]);
+  return true;
 }
 
-// ----- Playback -----
-bool Player::playTrack(uint16_t track) {
+bool Player::appendToSequence(uint16_t track) {
+  if (!_currentTrack || _loop || _seqCount >= SEQ_MAX) return false;
   if (track < 1) track = 1;
   if (track > DF_MAX_MP3) track = DF_MAX_MP3;
+  _seq[_seqCount++] = track;
+  return true;
+}
 
-  // Ensure path is quiet before starting anything new
-  relayOff();
-
-  if (!ensureReady()) return false;
-
-  // Double-check idle right before PLAY (protect against lingering activity)
-  (void)waitBusyLevel(HIGH, 500);
-
-  // Re-apply volume immediately before starting playback, in case DF reset or changed
-  _df.setVolume(_volume);
-  pumpDF(40);
-  _df.setVolume(_volume);
-  pumpDF(40);
-
-  // PLAY by index (0x12) – we rely on simple 1..N mapping
-  _df.send(0x12, track, false);
-  pumpDF(8);
-
-  // Confirm BUSY goes LOW (playing). If not, attempt one clean retry.
-  if (!waitBusyLevel(LOW, 900)) {
-    _df.send(0x16, 0, false);   // STOP
-    pumpDF(60);
-    (void)waitBusyLevel(HIGH, 500);
-
-    _df.send(0x12, track, false);
-    pumpDF(8);
-    if (!waitBusyLevel(LOW, 900)) {
-      // Still not playing — bail out without engaging the relay
-      _playing = false;
-      _currentTrack = 0;
-      return false;
-    }
+bool Player::requestPlay(uint16_t track, bool loop) {
+  if (track < 1) track = 1;
+  if (track > DF_MAX_MP3) track = DF_MAX_MP3;
+  if (!acceptsRequests()) {   // breaker open: coalesce into the one request the probe may play
+    _brk.refused++;
+    if (_heldTrack) _brk.coalesced++;
+    _heldTrack = track; _heldLoop = loop; _heldMs = millis();
+    return false;
   }
-
-  // Now actually playing → engage relay slightly after BUSY transitions
-  delay(AMP_ON_AFTER_BUSY_MS);
-  relayOn();
-
-  _playing = true;
+  // Same clip re-requested before BUSY confirmed it (CC-ID repeats): let the PLAY in flight land
+  if (_st == State::Confirming && track == _currentTrack && loop == _loop) return true;
   _currentTrack = track;
+  _loop = loop;
+  _seqCount = 0;
+  _powerOffAfterStop = false;
   _lastActiveMs = millis();
+
+  const Tier tier = (_st == State::Off || _st == State::Recovering)   ? Tier::Off
+                  : (_st == State::Standby || _st == State::Waking)   ? Tier::Standby
+                  : Tier::Warm;
+  _reqTier = (uint8_t)tier;
+  _reqMs = millis();
+
+  switch (_st) {
+    case State::Off:
+    case State::Standby:
+    case State::Idle:
+      startSequence();
+      break;
+    case State::Confirming:
+    case State::Playing:
+      _df.enqueue(0x16, 0);       // STOP; the new track starts once Stopping settles
+      enter(State::Stopping);
+      break;
+    default:
+      break;                      // bring-up / Starting / Stopping pick up _currentTrack
+  }
   return true;
 }
 
+void Player::prewake() {
+  _lastActiveMs = millis();   // restart the idle -> standby window
+  if (_st == State::Off || _st == State::Standby) startSequence();   // no track: ends in Idle
+}
+
 void Player::pause() {
-  if (!_dfPowered) return;
-  _df.pause(false);
-  pumpDF(8);
-  _playing = false;
+  if (_st != State::Playing && _st != State::Confirming) return;
+  _df.enqueue(0x0E, 0);       // PAUSE
+  _currentTrack = 0;
+  _loop = false;
+  _seqCount = 0;
   _lastActiveMs = millis();
-
-  // Give amp a moment before opening relay (reduces click)
-  delay(AMP_PRE_OFF_MS);
-  relayOff();
+  enter(State::Stopping);
 }
 
 void Player::stop(bool forcePowerOff) {
-  if (_dfPowered) {
-    _df.send(0x16, 0, false);   // STOP
-    pumpDF(20);
-    (void)waitBusyLevel(HIGH, 500);
-  }
-
-  _playing = false;
   _currentTrack = 0;
+  _loop = false;
+  _seqCount = 0;
   _lastActiveMs = millis();
 
-  delay(AMP_PRE_OFF_MS);
-  relayOff();
+  switch (_st) {
+    case State::Off:
+      return;
+    case State::Standby:
+    case State::Idle:
+      relayOff();
+      if (forcePowerOff) { powerOffDF(); enter(State::Off); }
+      return;
+    case State::Starting:
+    case State::Confirming:
+    case State::Playing:
+      _df.enqueue(0x16, 0);       // STOP
+      enter(State::Stopping);
+      break;
+    default:
+      break;                      // bring-up finishes into Idle (Starting sees no track)
+  }
+  if (forcePowerOff) _powerOffAfterStop = true;
+}
+
+void Player::loop() {
+  // Parse any DF inbound responses so our small queues never clog
+  _df.update();
+  bool tfFin = false;
+  while (_df.available()) {
+    const DFPMini::Event ev = _df.readEvent();
+    switch (ev.type) {
+      case DFPMini::EV_INIT:      _sawInit = true; invalidateShadow(); break;   // (re)booted: defaults
+      case DFPMini::EV_DEVICE_IN: _sawInit = true; _shadow.source = UNKNOWN; break;
+      case DFPMini::EV_VOL:       _shadow.volume = (uint8_t)ev.param; break;
+      case DFPMini::EV_EQ:        _shadow.eq     = (uint8_t)ev.param; break;
+      case DFPMini::EV_MODE:      _shadow.mode   = (uint8_t)ev.param; break;
+      case DFPMini::EV_TF_FIN:    // only the track now audible; a looped one goes on
+        if (ev.param == _finDup) { _finDup = 0; break; }   // repeat for the clip chained away from
+        if (_st == State::Playing && !_loop && ev.param == _currentTrack) tfFin = true;
+        break;
+      default: break;
+    }
+  }
+  if (_df.cmdStats().failed != _cmdFailSeen) {     // a setting may not have landed
+    _cmdFailSeen = _df.cmdStats().failed;
+    invalidateShadow();
+  }
 
-  if (forcePowerOff) powerOffDF();
+  // BUSY as tracked by the edge ISR (HIGH = idle)
+  uint8_t sreg = SREG; cli();
+  const bool     busyHigh = s_busyHigh;
+  const uint8_t  rises    = s_busyRises;
+  const uint32_t riseMs   = s_busyRiseMs;
+  SREG = sreg;
+  const bool rose = (rises != _busyRisesSeen);
+  _busyRisesSeen = rises;
+
+  if (_health == Health::Open && !_probing && elapsedSince(_openMs, _backoffMs) &&
+      (_st == State::Off || _st == State::Idle || _st == State::Standby)) startProbe();
+
+  switch (_st) {
+    case State::Off:
+      break;
+
+    case State::Recovering:
+      if (inStateFor(DF_POWER_CYCLE_OFF_MS)) {
+        _cold = true;
+        powerOnDF();
+        enter(State::Powering);
+      }
+      break;
+
+    case State::Standby:
+      maybeAutoSleep();
+      break;
+
+    case State::Waking:
+      if (inStateFor(DF_STANDBY_WAKE_MS)) enter(State::WaitingReady);
+      break;
+
+    case State::Idle:
+      if (_powerOffAfterStop) { _powerOffAfterStop = false; powerOffDF(); enter(State::Off); break; }
+      if (_bootDirty && inStateFor(BOOT_SAVE_IDLE_MS)) saveBootLearn();
+      maybeAutoSleep();
+      break;
+
+    case State::Powering:             // let power rails & DF core stabilize
+      if (_sawInit) {
+        // Power-up init already scanned the media: no RESET needed
+        learn(_boot.init, (uint16_t)(millis() - _powerOnMs));
+        (void)applySetting(_shadow.source, DFPMini::SRC_TF, 0x09);
+        enter(State::Resetting);
+        _step = 1;
+        break;
+      }
+      if (!inStateFor(wakeBoundMs())) break;
+      _df.clearPipeline();            // nothing queued survives a reset
+      invalidateShadow();
+      _df.reset(false);               // no INIT heard: RESET for internal reinit + media scan
+      _sawInit = false;
+      enter(State::Resetting);
+      break;
+
+    case State::Resetting:
+      if (_step == 0) {
+        if (!_sawInit && !inStateFor(DF_POST_RESET_MS)) break;
+        (void)applySetting(_shadow.source, DFPMini::SRC_TF, 0x09);   // ensure source is TF
+        _step = 1; _stT0 = millis();
+      } else if (_df.pipelineIdle()) {           // ACKed (or given up after retries)
+        enter(State::WaitingReady);
+      }
+      break;
+
+    case State::WaitingReady:         // BUSY HIGH means idle/ready
+      if (busyHigh) {
+        if (_cold) {
+          learn(_boot.ready, (uint16_t)(millis() - _powerOnMs));
+          _bootDirty = true;          // saved from Idle, never on the way to PLAY
+          _cold = false;
+        }
+        enter(State::SettingVolume);
+        break;
+      }
+      if (_cold ? inStateFor(DF_READY_TIMEOUT_MS) : inStateFor(WARM_IDLE_TIMEOUT_MS)) {
+        if (_cold) failPlay();        // DF never came up
+        else enter(State::SettingVolume);
+      }
+      break;
+
+    case State::SettingVolume:
+      // Apply volume/EQ where the shadow says the DF differs (after reset/power loss: always).
+      // Clones that drop the first command after reset simply miss the ACK: the pipeline resends.
+      // A warm module already matches, so its play is the PLAY frame alone.
+      if (_step == 0) {
+        (void)applySetting(_shadow.volume, _volume, 0x06);
+        (void)applySetting(_shadow.eq, _eq, 0x07);
+        _step = 1;
+      } else if (_df.pipelineIdle()) enter(State::Starting);
+      break;
+
+    case State::Starting:
+      if (!_currentTrack) { noteHealthy(); enter(State::Idle); break; }   // bring-up done, no track
+      if (_retried && !inStateFor(RETRY_STOP_MS)) break;
+      // Double-check idle right before PLAY (protect against lingering activity)
+      if (!busyHigh && !inStateFor(WARM_IDLE_TIMEOUT_MS)) break;
+      if (!_df.pipelineIdle()) break;            // PLAY leaves the UART the moment it is queued
+      // A single-track cycle left on from a looped track would repeat this one too
+      if (!_loop && _shadow.mode == DFPMini::MODE_SINGLE_REPEAT && _df.enqueue(0x19, 1))
+        _shadow.mode = DFPMini::MODE_REPEAT;
+      // PLAY by index (0x12) – we rely on simple 1..N mapping
+      _df.enqueue(0x12, _currentTrack);
+      LatTrace::markActive(LatTrace::PLAY_CMD);
+      notePlaySent();
+      if (_loop && _df.enqueue(0x19, 0)) _shadow.mode = DFPMini::MODE_SINGLE_REPEAT;   // cycles what PLAY started
+      enter(State::Confirming);
+      break;
+
+    case State::Confirming:
+      if (_step == 0) {
+        if (busyHigh || rose) _playSawIdle = true;   // BUSY let go since the PLAY
+        if (!busyHigh && _playSawIdle) {   // playing: engage relay slightly after BUSY transitions
+          LatTrace::markActive(LatTrace::BUSY_LOW);
+          _step = 1; _stT0 = millis();
+        } else if (inStateFor(PLAY_CONFIRM_MS)) {
+          if (_retried) { failPlay(); break; }
+          _retried = true;            // one clean retry: STOP, settle, PLAY again
+          _df.enqueue(0x16, 0);
+          enter(State::Starting);
+        }
+      } else if (_relayOn || inStateFor(AMP_ON_AFTER_BUSY_MS)) {   // chained clip: relay never opened
+        relayOn();
+        if (_reqTier < TIERS) {
+          TierStats &t = _tierStats[_reqTier];
+          t.n++; t.sumMs += (uint32_t)(millis() - _reqMs);
+          _reqTier = 0xFF;
+        }
+        _lastActiveMs = millis();
+        noteHealthy();
+        enter(State::Playing);
+      }
+      break;
+
+    case State::Playing:
+      _lastActiveMs = millis();
+      // Completion: BUSY rose (Playing is only entered with BUSY LOW, so any rise is this
+      // track's) or EV_TF_FIN for it. Looped: the DF's repeat gap blips BUSY; only a long HIGH ends it.
+      if (_loop) { if (busyHigh && (uint32_t)(millis() - riseMs) >= LOOP_BUSY_GAP_MS) finishTrack(); }
+      else if (tfFin || rose || busyHigh) {
+        if (!_seqCount && _nextFn) { const uint16_t t = _nextFn(_nextCtx); if (t) (void)appendToSequence(t); }
+        if (_seqCount) chainNext(); else finishTrack();
+      }
+      break;
+
+    case State::Stopping:
+      // Give amp a moment before opening relay (reduces click); BUSY should be HIGH by then
+      if (!inStateFor(AMP_PRE_OFF_MS) || (!busyHigh && !inStateFor(WARM_IDLE_TIMEOUT_MS))) break;
+      relayOff();
+      _lastActiveMs = millis();
+      if (_currentTrack) startSequence();                        // a new request arrived meanwhile
+      else if (_powerOffAfterStop) { _powerOffAfterStop = false; powerOffDF(); enter(State::Off); }
+      else enter(State::Idle);
+      break;
+  }
+
+  if (_finished) {
+    const uint16_t t = _finished;
+    _finished = 0;
+    if (_finFn) _finFn(_finCtx, t);
+  }
 }
 
 // ----- Relay helpers -----
@@ -228,6 +552,7 @@ void Player::relayOn() {
   if (_relayOn) return;
   digitalWrite(PIN_SPK_RELAY, HIGH);
   _relayOn = true;
+  LatTrace::markActive(LatTrace::RELAY_ON);
 }
 
 void Player::relayOff() {
@@ -236,31 +561,17 @@ void Player::relayOff() {
   _relayOn = false;
 }
 
-// ----- Autosleep & loop -----
+// ----- Autosleep: Idle -> warm standby -> off -----
 void Player::maybeAutoSleep() {
   if (_bench) return;        // never autosleep in bench mode
   if (!_dfPowered) return;   // already off
-  if (_playing) {
-    _lastActiveMs = millis();
-    return;
-  }
-  if (elapsedSince(_lastActiveMs, DF_AUTOSLEEP_DELAY_MS)) {
-    // Clean shutdown path: drop relay first, then DF power
+  if (_st == State::Idle && elapsedSince(_lastActiveMs, DF_AUTOSLEEP_DELAY_MS)) {
     relayOff();
+    _df.enqueue(0x0A, 0);    // STANDBY: DF keeps power, a later play skips the cold boot
+    enter(State::Standby);
+  } else if (_st == State::Standby && elapsedSince(_stT0, DF_STANDBY_OFF_MS)) {
+    // Clean shutdown path: drop relay first, then DF power
     powerOffDF();
+    enter(State::Off);
   }
 }
-
-void Player::loop() {
-  // Parse any DF inbound responses so our small queues never clog
-  _df.update();
-  while (_df.available()) (void)_df.readEvent();
-
-  // Detect playback completion via BUSY (HIGH = idle)
-  if (_playing && digitalRead(PIN_DF_BUSY) == HIGH) {
-    // Logical stop; no need to power off immediately
-    stop(false);
-  }
-
-  maybeAutoSleep();
-}
@@ -1,9 +1,11 @@
 #pragma once
 #include <Arduino.h>
-#include <SoftwareSerial.h>
+#include <EEPROM.h>
 #include "DFPMini.h"
+#include "DfLink.h"
 #include "Pins.h"
 #include "CCIDMap.h"
+#include "LatencyTrace.h"
 
 class Player {
 public:
@@ -11,10 +13,10 @@ public:
   static const uint8_t  DF_VOLUME_DEFAULT = 12;    // 0..30
   static const uint8_t  DF_VOLUME_MAX     = 30;
 
-  // Power-up settle before talking to DF mini after EN=HIGH
+  // Power-up settle before talking to DF mini after EN=HIGH (upper bound: EV_INIT ends it early)
   static const uint16_t DF_WAKE_MS        = 350;
 
-  // Extra settle after sending RESET (internal init / media scan)
+  // Extra settle after sending RESET (internal init / media scan; upper bound, EV_INIT ends it early)
   static const uint16_t DF_POST_RESET_MS  = 400;
 
   // Total time to wait for DF to report "idle/ready" (BUSY=HIGH) after boot
@@ -24,8 +26,23 @@ public:
   static const uint16_t AMP_ON_AFTER_BUSY_MS = 60;   // delay after BUSY goes LOW (playing) before relay ON
   static const uint16_t AMP_PRE_OFF_MS       = 80;   // small delay before relay OFF to avoid click
 
-  // Idle autosleep (power cut) when not playing
-  static const uint32_t DF_AUTOSLEEP_DELAY_MS = 10000; // 10s
+  // Power tiers: Idle (powered, relay open) -> warm standby (0x0A) -> off (power cut)
+  static const uint32_t DF_AUTOSLEEP_DELAY_MS = 10000;   // idle time before standby
+  static const uint32_t DF_STANDBY_OFF_MS     = 600000;  // standby time before power cut (10 min)
+  static const uint16_t DF_STANDBY_WAKE_MS    = 100;     // settle after NORMAL (0x0B)
+
+  // Looped track: BUSY may blip HIGH between the DF's own repeats; only a longer HIGH ends it
+  static const uint16_t LOOP_BUSY_GAP_MS      = 250;
+
+  // Circuit breaker: a failed play degrades (next start power-cycles the DF); BREAKER_TRIP_FAILS in
+  // a row open it (DF off, requests refused). After the backoff one probe power-cycles and boots the
+  // DF, playing the last refused request if it is younger than BREAKER_HOLD_MS; a failed probe
+  // doubles the backoff up to BREAKER_MAX_MS.
+  static const uint8_t  BREAKER_TRIP_FAILS    = 3;
+  static const uint16_t BREAKER_BASE_MS       = 2000;
+  static const uint32_t BREAKER_MAX_MS        = 64000;
+  static const uint16_t BREAKER_HOLD_MS       = 5000;
+  static const uint16_t DF_POWER_CYCLE_OFF_MS = 300;     // rail discharge before a recovery power-on
 
   Player();
 
@@ -33,56 +50,200 @@ public:
   void begin();
   void setBenchMode(bool bench) { _bench = bench; }
 
-  // playback
-  bool playTrack(uint16_t track);                 // 1..DF_MAX_MP3
-  // Player.h
+  // playback (non-blocking): the request is taken at once and loop() walks the DF through
+  // power-up -> reset -> ready -> volume -> PLAY -> BUSY confirm -> relay, one step per pass.
+  // loop: the DF repeats the track itself (single-track cycle, 0x19) until stop() or a preempting
+  // request — no UART traffic, relay or BUSY handshakes between repeats.
+  bool requestPlay(uint16_t track, bool loop = false);   // 1..DF_MAX_MP3; preempts the current track
+  // Sequence: clips back to back. The next PLAY (0x12) leaves on the previous clip's TF_FIN/BUSY
+  // edge; the relay stays closed and volume/readiness steps are skipped, so the gap is the decoder's.
+  // onTrackFinished() fires once, for the last clip. Any requestPlay()/stop() drops what is pending.
+  static const uint8_t SEQ_MAX = 4;                           // clips pending behind the current one
+  bool requestSequence(const uint16_t* tracks, uint8_t n);    // n: 1..SEQ_MAX+1
+  bool appendToSequence(uint16_t track);                      // false: nothing playing, looped or full
+  uint8_t sequencePending() const { return _seqCount; }
+
   bool playCCID(uint16_t ccid) {
     uint16_t tr = trackForCcid(ccid);   // e.g. CC-ID 0 -> 23
     if (tr < 1) tr = 1;                 // guard for old maps / bad data
-    return playTrack(tr);               // playTrack() will clamp to DF_MAX_MP3
+    return requestPlay(tr);             // requestPlay() will clamp to DF_MAX_MP3
   }
 
-  void stop(bool forcePowerOff = false);
+  void stop(bool forcePowerOff = false);          // relay opens from loop() after AMP_PRE_OFF_MS
+
+  // Leading indicator (unlock, door open, KL15 on): bring the DF to Idle ahead of any intent
+  void prewake();
   void pause();
 
-  // loop
+  // loop: advances the state machine; never sleeps
   void loop();
 
-  // volume
+  // Track over: BUSY rose (edge ISR) or EV_TF_FIN named the current track, or the play failed.
+  // Raised from loop() in the same pass; not for stop() or a request that preempts the track.
+  // EV_TF_FIN for any other track (a stopped or replaced one) is stale and ignored.
+  typedef void (*FinishedFn)(void* ctx, uint16_t track);
+  void setOnTrackFinished(FinishedFn fn, void* ctx) { _finFn = fn; _finCtx = ctx; }
+
+  // Next clip, pulled on a natural end when no sequence clip is pending (not for looped tracks):
+  // a non-zero track is chained like a sequence clip in the same pass, and no finish event is
+  // raised. The owner's queue keeps its intents until the moment one can actually play.
+  typedef uint16_t (*NextFn)(void* ctx);
+  void setNextClip(NextFn fn, void* ctx) { _nextFn = fn; _nextCtx = ctx; }
+
+  // ISR entry (BUSY edge) — not for loop() use
+  static void isrBusy();
+
+  // volume / EQ (sent only when the DF's shadowed setting differs)
   void setVolume(uint8_t v);
   uint8_t volume() const { return _volume; }
+  void setEQ(DFPMini::EQ eq);
+
+  // Shadow of the DF's own settings; UNKNOWN after power loss, RESET or a spontaneous INIT.
+  static const uint8_t UNKNOWN = 0xFF;
+  struct DfShadow { uint8_t volume, eq, source, mode; };
+  const DfShadow& shadow() const { return _shadow; }
+  void verifyShadow();                            // queries volume/EQ/mode; replies correct the shadow
 
   // state
-  bool isPlaying() const { return _playing; }
+  enum class State : uint8_t {
+    Off,            // DF unpowered
+    Standby,        // powered, DF in standby (0x0A), relay open
+    Waking,         // NORMAL (0x0B) sent, settling (DF_STANDBY_WAKE_MS)
+    Idle,           // powered, ready, relay open
+    Powering,       // EN high, rails settling (DF_WAKE_MS)
+    Resetting,      // RESET + source select, media scan (DF_POST_RESET_MS)
+    WaitingReady,   // BUSY HIGH = idle/ready
+    SettingVolume,  // volume/EQ/source only where the shadow differs
+    Starting,       // idle check, then PLAY
+    Confirming,     // BUSY LOW, then relay after AMP_ON_AFTER_BUSY_MS
+    Playing,
+    Stopping,       // STOP/PAUSE sent; relay opens after AMP_PRE_OFF_MS
+    Recovering      // breaker: DF power held off (DF_POWER_CYCLE_OFF_MS) before a cold start
+  };
+  State state() const { return _st; }
+  bool isPlaying() const { return _currentTrack != 0; }     // requested, starting or playing
+  bool isAudible() const { return _st == State::Playing; }  // BUSY confirmed, relay closed
+  bool isLooping() const { return _loop && _currentTrack != 0; }
   bool isAwake()   const { return _dfPowered; }
   uint16_t currentTrack() const { return _currentTrack; }
 
+  // Audio path health
+  enum class Health : uint8_t { Healthy, Degraded, Open };
+  struct BreakerStats {
+    uint16_t failures;        // failed plays / bring-ups
+    uint16_t trips;           // Healthy/Degraded -> Open
+    uint16_t probes, recoveries;
+    uint16_t refused;         // requests while Open (held for the probe, newest wins)
+    uint16_t coalesced;       // of those, replaced an older held request
+  };
+  Health health() const { return _health; }
+  bool acceptsRequests() const { return _health != Health::Open || _probing; }
+  const BreakerStats& breakerStats() const { return _brk; }
+  uint32_t breakerBackoffMs() const { return _backoffMs; }
+
+  // Request -> relay ON latency, split by the power tier the request found the DF in
+  enum class Tier : uint8_t { Off, Standby, Warm };
+  static const uint8_t TIERS = 3;
+  struct TierStats {
+    uint16_t n; uint32_t sumMs;
+    uint16_t avgMs() const { return n ? (uint16_t)(sumMs / n) : 0; }
+  };
+  const TierStats& tierStats(Tier t) const { return _tierStats[(uint8_t)t]; }
+
+  // Learned cold-boot timing of this module (EEPROM-backed)
+  //   init:  EN high -> EV_INIT/EV_DEVICE_IN   ready: EN high -> BUSY idle after source select
+  struct BootPhase { uint8_t n; uint16_t minMs, avgMs, maxMs; };   // avg: EWMA (1/8) after 8 samples
+  struct BootLearn { uint8_t magic; BootPhase init, ready; };
+  static const int     EE_BOOT_ADDR  = 0;
+  static const uint8_t EE_BOOT_MAGIC = 0xB7;
+  const BootLearn& bootLearn() const { return _boot; }
+  void resetBootLearn();
+
+  // DF command pipeline: sends, ACKs, retries, failures, round-trip times
+  const DFPMini::CmdStats& cmdStats() const { return _df.cmdStats(); }
+
 private:
-  // readiness & power
-  bool ensureReady();                               // fully (re)connect & wait for DF to be ready (and set volume)
+  static const uint16_t WARM_IDLE_TIMEOUT_MS = 500;  // idle check before PLAY on a running DF
+  static const uint16_t PLAY_CONFIRM_MS      = 900;  // BUSY must go LOW within this after PLAY
+  static const uint16_t RETRY_STOP_MS        = 60;   // STOP settle before the one PLAY retry
+  static const uint16_t BOOT_SAVE_IDLE_MS    = 2000; // learned boot times go to EEPROM only this far into Idle
+  static const uint16_t BOOT_SAVE_TOL_MS     = 40;   // ... and only when min/avg/max moved further than this
+
+  void enter(State s);
+  void invalidateShadow() { _shadow.volume = _shadow.eq = _shadow.source = _shadow.mode = UNKNOWN; }
+  bool applySetting(uint8_t& shadowed, uint8_t want, uint8_t cmd);   // enqueue only on change
+  uint16_t wakeBoundMs() const;                     // DF_WAKE_MS, tightened once the INIT time is known
+  static void learn(BootPhase& p, uint16_t ms);
+  static bool drifted(const BootPhase& saved, const BootPhase& now);
+  void saveBootLearn();                             // EEPROM write (~3.4 ms per changed byte): Idle only
+  bool inStateFor(uint16_t ms) const;
+  void startSequence();                             // from Off (cold) or Idle (warm)
+  void failPlay();
+  void finishTrack();                               // natural end: STOP + Stopping, raise the event
+  void chainNext();                                 // natural end with a clip pending: PLAY it now
+  void notePlaySent();                              // PLAY queued: BUSY history before it is not this clip's
+  void noteHealthy();                               // bring-up or play succeeded
+  void noteFailure();                               // from failPlay()
+  void startProbe();
+
+  // power
   void powerOnDF();
   void powerOffDF();
+  void openLink();                                  // (re)start the DF link + DFPMini: only on DF power-up
 
   // relay control
   void relayOn();
   void relayOff();
 
-  // waits & helpers
-  bool waitBusyLevel(int level, uint16_t timeout_ms);
-  bool waitForDFReady(uint16_t timeout_ms);         // BUSY==HIGH and/or init events
-  void pumpDF(uint16_t ms);                         // parse/flush inbound frames while waiting
   void maybeAutoSleep();
   static inline bool elapsedSince(uint32_t start_ms, uint32_t ms);
 
-  SoftwareSerial _ss;
-  DFPMini _df;
+  DFPMini _df;                                      // over DfLink::port()
 
   bool _bench = false;
   bool _dfPowered = false;
   bool _relayOn = false;
-  bool _playing = false;
+
+  State    _st = State::Off;
+  uint32_t _stT0 = 0;        // state entry / last sub-step time
+  uint8_t  _step = 0;        // sub-step inside a state
+  bool     _cold = false;    // start sequence began from power-off
+  bool     _retried = false; // PLAY retried once already
+  bool     _powerOffAfterStop = false;
+  bool     _sawInit = false; // EV_INIT / EV_DEVICE_IN since the last power-on or RESET
+  uint32_t _powerOnMs = 0;
+  BootLearn _boot;
+  bool      _bootDirty = false;   // _boot learned something since the last EEPROM compare
+
+  TierStats _tierStats[TIERS] = {};
+  uint8_t   _reqTier = 0xFF;   // tier of the request being started (0xFF: none)
+  uint32_t  _reqMs = 0;
 
   uint16_t _currentTrack = 0;
+  bool     _loop = false;                         // _currentTrack repeats on the DF (shadow.mode tracks 0x19)
+  uint16_t _seq[SEQ_MAX];                         // pending clips, _seq[0] next
+  uint8_t  _seqCount = 0;
+
+  Health   _health = Health::Healthy;
+  bool     _probing = false;
+  uint8_t  _consecFails = 0;
+  uint32_t _backoffMs = 0, _openMs = 0;
+  uint16_t _heldTrack = 0;                        // newest request refused while Open
+  bool     _heldLoop = false;
+  uint32_t _heldMs = 0;
+  BreakerStats _brk = {};
   uint8_t _volume = DF_VOLUME_DEFAULT;
+  uint8_t _eq = UNKNOWN;                          // UNKNOWN: leave the module's EQ alone
+  DfShadow _shadow = { UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN };
+  uint16_t _cmdFailSeen = 0;                      // DFPMini failed count already folded into the shadow
   uint32_t _lastActiveMs = 0;
+
+  FinishedFn _finFn = nullptr;
+  void*      _finCtx = nullptr;
+  NextFn     _nextFn = nullptr;
+  void*      _nextCtx = nullptr;
+  uint16_t   _finished = 0;                       // raised at the end of this loop() pass
+  uint8_t    _busyRisesSeen = 0;
+  bool       _playSawIdle = false;                  // BUSY HIGH (or a rise) seen since the last PLAY
+  uint16_t   _finDup = 0;                           // clip chainNext() replaced: a repeated TF_FIN of it is stale
 };
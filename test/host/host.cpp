@@ -0,0 +1,35 @@
+// Host runtime behind shim/: fake clock, AVR register storage, SPI routed to a test device.
+#include "host.h"
+
+volatile uint8_t PINB, PCICR, PCMSK0, TIMSK0, OCR0B, SREG;
+volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2, TIFR2;
+HardwareSerial Serial;
+SPIClass SPI;
+
+namespace HostClock {
+uint32_t us = 0;
+uint32_t delayCalls = 0;
+void advanceMs(uint32_t ms){ us += ms * 1000UL; }
+}
+unsigned long millis(){ return HostClock::us / 1000UL; }
+unsigned long micros(){ return HostClock::us; }
+// Nothing under test may sleep: count the call and let time pass so a stray wait is visible
+void delay(unsigned long ms){ HostClock::delayCalls++; HostClock::us += ms * 1000UL; }
+void delayMicroseconds(unsigned int us){ HostClock::delayCalls++; HostClock::us += us; }
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int  digitalRead(uint8_t) { return HIGH; }
+
+namespace HostSpi { Device* device = nullptr; }
+void SPIClass::beginTransaction(SPISettings){ if(HostSpi::device) HostSpi::device->select(); }
+void SPIClass::endTransaction(){ if(HostSpi::device) HostSpi::device->deselect(); }
+uint8_t SPIClass::transfer(uint8_t b){ return HostSpi::device ? HostSpi::device->transfer(b) : 0; }
+
+namespace HostTest {
+int failures = 0;
+void fail(const char* file, int line, const char* expr){
+  printf("%s:%d: CHECK(%s) failed\n", file, line, expr);
+  failures++;
+}
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <Arduino.h>
+#include <SPI.h>
+#include <stdio.h>
+
+// Fake time base: millis()/micros() move only when a test calls advanceMs().
+namespace HostClock {
+extern uint32_t us;
+extern uint32_t delayCalls;   // delay()/delayMicroseconds() calls: must stay 0 in non-blocking code
+void advanceMs(uint32_t ms);
+}
+
+namespace HostTest {
+extern int failures;
+void fail(const char* file, int line, const char* expr);
+}
+#define CHECK(e) do { if(!(e)) HostTest::fail(__FILE__, __LINE__, #e); } while(0)
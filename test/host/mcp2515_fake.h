@@ -0,0 +1,64 @@
+#pragma once
+// MCP2515 register file behind HostSpi: RESET, WRITE, READ, BIT MODIFY, READ STATUS and RTS,
+// the instructions CanBus and mcp_can issue. Mode requests on CANCTRL show up in CANSTAT at once.
+// A requested TX buffer goes on the wire immediately (logged with millis()) unless `hold` is set.
+#include "host.h"
+#include "mcp_can.h"
+#include <vector>
+
+struct FakeMcp2515 : HostSpi::Device {
+  struct Sent { uint32_t t; uint16_t id; uint8_t len; uint8_t d[8]; };
+  uint8_t reg[128] = {};
+  std::vector<Sent> sent;
+  bool hold = false;
+  uint8_t op = 0, addr = 0, mask = 0, n = 0;
+
+  static uint8_t ctrl(uint8_t b){ return (uint8_t)(MCP_TXB0CTRL + 0x10 * b); }
+  void reset(){
+    memset(reg, 0, sizeof(reg));
+    reg[MCP_CANCTRL] = 0x87; reg[MCP_CANSTAT] = MODE_CONFIG;
+  }
+  void store(uint8_t a, uint8_t v){
+    a &= 0x7F; reg[a] = v;
+    if(a == MCP_CANCTRL) reg[MCP_CANSTAT] = (uint8_t)((reg[MCP_CANSTAT] & ~MODE_MASK) | (v & MODE_MASK));
+  }
+  void transmit(uint8_t b){
+    const uint8_t* r = &reg[ctrl(b)];
+    Sent s; s.t = millis(); s.id = (uint16_t)((r[1] << 3) | (r[2] >> 5)); s.len = r[5] & 0x0F;
+    memcpy(s.d, r + 6, 8);
+    sent.push_back(s);
+    reg[ctrl(b)] &= (uint8_t)~MCP_TXB_TXREQ_M;
+    reg[MCP_CANINTF] |= (uint8_t)(MCP_TX0IF << b);
+  }
+  void release(){ hold = false; for(uint8_t b=0;b<3;b++) if(reg[ctrl(b)] & MCP_TXB_TXREQ_M) transmit(b); }
+  uint8_t status() const {
+    uint8_t s = 0;
+    for(uint8_t b=0;b<3;b++){
+      if(reg[ctrl(b)] & MCP_TXB_TXREQ_M)      s |= (uint8_t)(0x04 << (2 * b));
+      if(reg[MCP_CANINTF] & (MCP_TX0IF << b)) s |= (uint8_t)(0x08 << (2 * b));
+    }
+    return s;
+  }
+
+  void select() override { n = 0; }
+  uint8_t transfer(uint8_t v) override {
+    const uint8_t i = n++;
+    if(i == 0){
+      op = v;
+      if(v == MCP_RESET) reset();
+      else if((v & 0xF8) == 0x80)                   // RTS TXBn
+        for(uint8_t b=0;b<3;b++) if(v & (1u << b)){ reg[ctrl(b)] |= MCP_TXB_TXREQ_M; if(!hold) transmit(b); }
+      return 0;
+    }
+    switch(op){
+      case MCP_READ_STATUS: return status();
+      case MCP_WRITE:  if(i == 1) addr = v; else store(addr++, v); return 0;
+      case MCP_READ:   if(i == 1){ addr = v; return 0; } return reg[addr++ & 0x7F];
+      case MCP_BITMOD:
+        if(i == 1) addr = v; else if(i == 2) mask = v;
+        else store(addr, (uint8_t)((reg[addr & 0x7F] & ~mask) | (v & mask)));
+        return 0;
+    }
+    return 0;
+  }
+};
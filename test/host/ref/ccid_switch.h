@@ -0,0 +1,138 @@
+#pragma once
+// Reference copy of the CC-ID resolution before the PROGMEM table (CCIDMap.h switch +
+// Filter::classifyCcid == chains). Frozen: test_ccid_table checks Ccid::lookup() against it.
+// Include inside a namespace; it needs <stdint.h> only.
+
+inline uint16_t trackForCcid(uint16_t id) {
+  switch (id) {
+    case 0:   return 23; // all system ok
+
+    // Seatbelt
+    case 46: case 91: case 389: case 390: return 2;
+
+    // Doors / trunk / hood
+    case 16:  return 3;   // rear left
+    case 17:  return 4;   // rear right
+    case 19:  return 9;   // trunk
+    case 18:  return 10;  // hood
+    case 14:  return 11;  // passenger door
+    case 15:  return 12;  // driver door
+
+    // Parking brake & key
+    case 55:  return 5;   // parking brake not down
+    case 38: case 205: case 66: return 6; // key not found
+    case 13:  return 21;  // don't forget key
+
+    // Caps / preheat / lights
+    case 32:  return 7;   // fill cap open
+    case 25:  return 8;   // preheating wait
+    case 113: return 16;  // side lights
+
+    // Fluids & coolant & fuel
+    case 166: return 17;                // coolant low
+    case 164: return 18;                // low washer liquid
+    case 275: case 286: return 19;      // low fuel
+    case 167: return 20;                // set time
+
+    // Battery low (added 415)
+    case 306: case 304: case 229: case 220: case 415: return 22;
+
+    // Bulbs out
+    case 87: case 88: case 89: case 111: case 114: case 115: case 116: case 117: case 118:
+    case 119: case 120: case 121: case 122: case 123: case 124: case 125: case 126: case 127:
+    case 128: case 129: case 130: case 131: case 132: case 133: case 134: case 135: case 136:
+    case 137: case 138: case 196: case 197: case 345: case 346: case 371: case 372: case 373:
+    case 378: case 379: case 380: case 381: return 24;
+
+    // Tyres
+    case 139: case 608: return 25;   // front left
+    case 143: case 609: return 26;   // front right
+    case 140: case 610: return 27;   // rear right
+    case 141: case 611: return 28;   // rear left
+    case 142: return 29;             // pressure not same
+    case 265: return 30;             // overfilled
+    case 63: case 384: return 37;    // air leak
+
+    // Oil / power / faults
+    case 27: case 28: return 31;                                   // low oil level
+    case 29: case 31: case 49: case 216: return 32;                // motor power reduced
+    case 30: case 33: case 39: case 212: case 427: case 961: case 568: return 33; // motor fault stop
+    case 182: return 34;                                           // oil level sensor fault
+    case 213: return 35;                                           // alternator fault
+    case 257: case 367: return 36;                                 // engine overheating
+
+    // Brakes, traction, road/maintenance
+    case 71:  return 38;                     // brake pads worn
+    case 74:  return 39;                     // low brake fluid
+    case 184: return 40;                     // traction mode active
+    case 36:  return 41;                     // traction mode deactivated
+    case 35: case 236: case 237: case 382: return 42; // traction control fault
+    case 79: case 165: return 43;            // ice roads
+    case 281: case 284: return 44;           // maintenance required
+
+    // Key battery low
+    case 67:  return 51;
+
+    // Custom/synthetic IDs (optional; keep if used elsewhere)
+    case 1001: return 45; // don't forget to fill up (reminder)
+    case 1002: return 46; // goodbye driver
+    case 1003: return 47; // goodbye driver 2
+    case 1004: return 48; // goodbye driver & passenger
+    case 1005: return 49; // goodbye driver & passenger 2
+    case 1006: return 50; // handbrake not up
+
+    default: return 14;   // generic warning gong
+  }
+}
+
+// Helpers stay the same, with 415 included in battery-low set.
+inline bool isSeatbeltCCID(uint16_t id){
+  return (id==46 || id==91 || id==389 || id==390);
+}
+
+inline bool isBatteryLowCCID(uint16_t id){
+  return (id==306 || id==304 || id==229 || id==220 || id==415);
+}
+
+inline bool isLowFuelCCID(uint16_t id){
+  return (id==275 || id==286);
+}
+
+// Returns true if the given CC-ID is a "battery low" warning
+inline bool isLowBatteryCCID(uint16_t ccid) {
+  switch (ccid) {
+    case 306: case 304: case 229: case 220: case 415:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// ccidStatus: 0x02 = Active, 0x01 = Cleared
+static inline bool isLowBatteryActive(uint16_t ccid, uint8_t ccidStatus) {
+  return (ccidStatus == 0x02) && isLowBatteryCCID(ccid);
+}
+
+// Filter::classifyCcid: 3 = A1, 2 = A2, 1 = A3, 0 = A4/B
+inline int classifyCcid(uint16_t ccid, uint8_t& prio){
+  // A1: Stop-Now
+  if (ccid==30 || ccid==33 || ccid==39 || ccid==212 || ccid==427 || ccid==961 || ccid==568 ||
+      ccid==257 || ccid==367 || ccid==74) { prio=3; return 3; }
+
+  // A2: Drive-Now (seatbelt + doors/hood/trunk)
+  if (ccid==46 || ccid==91 || ccid==389 || ccid==390 ||
+      ccid==14 || ccid==15 || ccid==16 || ccid==17 || ccid==18 || ccid==19) { prio=2; return 2; }
+
+  // A3: High-severity
+  if (ccid==29 || ccid==31 || ccid==49 || ccid==216 ||
+      ccid==213 ||
+      ccid==35 || ccid==236 || ccid==237 || ccid==382 ||
+      ccid==166 ||
+      ccid==306 || ccid==304 || ccid==229 || ccid==220 || ccid==415 ||
+      ccid==139 || ccid==143 || ccid==140 || ccid==141 ||
+      ccid==608 || ccid==609 || ccid==610 || ccid==611 ||
+      ccid==142 || ccid==265 ||
+      ccid==63  || ccid==384) { prio=1; return 1; }
+
+  prio=0; return 0; // A4 + B
+}
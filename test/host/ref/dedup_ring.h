@@ -0,0 +1,39 @@
+#pragma once
+// Reference copy of the de-dup history CanBus used before the per-ID slots: one 10-entry ring
+// shared by every ID, searched linearly. Frozen: test_dedup compares CanBus::isDuplicate() to it.
+#include <stdint.h>
+
+struct DedupRing {
+  struct FrameRec { uint32_t id; uint8_t len; uint8_t data[8]; uint32_t t; bool valid; };
+  static const uint8_t MAX_HISTORY = 10;
+  FrameRec _hist[MAX_HISTORY];
+  uint8_t  _histHead = 0;
+  uint8_t  _historyDepth = 10;
+  uint16_t _dedupWindowMs = 300;
+
+  DedupRing(){ for(uint8_t i=0;i<MAX_HISTORY;i++) _hist[i].valid=false; }
+
+  bool isDuplicate(uint32_t id, uint8_t len, const uint8_t *buf, uint32_t now) const{
+    const uint16_t win=_dedupWindowMs; const uint8_t depth=_historyDepth;
+    for(uint8_t i=0;i<depth && i<MAX_HISTORY;i++){
+      const FrameRec&r=_hist[i]; if(!r.valid) continue;
+      if((uint32_t)(now - r.t) > win) continue;
+      if(r.id!=id || r.len!=len) continue;
+      bool same=true; for(uint8_t b=0;b<len;b++){ if(r.data[b]!=buf[b]){ same=false; break; } }
+      if(same) return true;
+    }
+    return false;
+  }
+  void pushHistory(uint32_t id, uint8_t len, const uint8_t *buf, uint32_t now){
+    FrameRec&r=_hist[_histHead];
+    r.id=id; r.len=len; r.t=now; r.valid=true;
+    for(uint8_t i=0;i<len && i<8;i++) r.data[i]=buf[i];
+    _histHead++; if(_histHead>=MAX_HISTORY) _histHead=0;
+  }
+  // readOnceDistinct() used the pair like this
+  bool accept(uint32_t id, uint8_t len, const uint8_t *buf, uint32_t now){
+    if(isDuplicate(id,len,buf,now)) return false;
+    pushHistory(id,len,buf,now);
+    return true;
+  }
+};
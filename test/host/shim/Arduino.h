@@ -0,0 +1,74 @@
+#pragma once
+// Host stand-in for the AVR Arduino core: just enough for the src/ units the host tests link.
+// millis()/micros() read a fake clock that only the test advances (host.cpp).
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+typedef uint8_t byte;
+typedef bool    boolean;
+#define HIGH   1
+#define LOW    0
+#define INPUT  0
+#define OUTPUT 1
+#define DEC 10
+#define HEX 16
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t* b, size_t n) { size_t k = 0; while(n--) k += write(*b++); return k; }
+  virtual int availableForWrite() { return 0; }
+  template<class T> size_t print(T)        { return 0; }
+  template<class T> size_t print(T, int)   { return 0; }
+  template<class T> size_t println(T)      { return 0; }
+  template<class T> size_t println(T, int) { return 0; }
+  size_t println()                         { return 0; }
+};
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual void flush() {}
+};
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  void end() {}
+  size_t write(uint8_t) override { return 1; }
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+};
+extern HardwareSerial Serial;
+
+#define digitalPinToPort(p)       (p)
+#define digitalPinToBitMask(p)    (1 << ((p) & 7))
+#define portInputRegister(p)      (&PINB)
+#define digitalPinToPCICR(p)      (&PCICR)
+#define digitalPinToPCICRbit(p)   0
+#define digitalPinToPCMSK(p)      (&PCMSK0)
+#define digitalPinToPCMSKbit(p)   0
+#define _BV(b) (1 << (b))
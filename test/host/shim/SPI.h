@@ -0,0 +1,27 @@
+#pragma once
+#include <Arduino.h>
+#define MSBFIRST  1
+#define SPI_MODE0 0
+
+struct SPISettings { SPISettings() {} SPISettings(uint32_t, uint8_t, uint8_t) {} };
+
+// Every byte goes to HostSpi::device (host.cpp); a transaction brackets one chip-select.
+class SPIClass {
+public:
+  void begin() {}
+  void beginTransaction(SPISettings);
+  void endTransaction();
+  uint8_t transfer(uint8_t b);
+  void usingInterrupt(uint8_t) {}
+};
+extern SPIClass SPI;
+
+namespace HostSpi {
+struct Device {
+  virtual ~Device() {}
+  virtual void    select() {}
+  virtual uint8_t transfer(uint8_t) { return 0; }
+  virtual void    deselect() {}
+};
+extern Device* device;   // nullptr: reads as 0
+}
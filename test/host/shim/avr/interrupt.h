@@ -0,0 +1,8 @@
+#pragma once
+// Single-threaded host: interrupts never fire, so masking them is a no-op.
+#define ISR(v, ...) extern "C" void v(void)
+#define cli() ((void)0)
+#define sei() ((void)0)
+#define PCINT0_vect        __vector_3
+#define TIMER2_COMPB_vect  __vector_8
+#define TIMER0_COMPB_vect  __vector_15
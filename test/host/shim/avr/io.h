@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+// ATmega328P registers the src/ units touch; plain storage on the host (host.cpp).
+extern volatile uint8_t PINB, PCICR, PCMSK0, TIMSK0, OCR0B, SREG;
+extern volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2, TIFR2;
+#define OCIE0B 2
+#define SREG_I 7
+// Timer2
+#define WGM21  1
+#define COM2B0 4
+#define COM2B1 5
+#define CS21   1
+#define FOC2B  6
+#define OCIE2B 2
+#define OCF2B  2
@@ -0,0 +1,9 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#define PROGMEM
+#define PSTR(s)            (s)
+#define pgm_read_byte(a)   (*(const uint8_t*)(a))
+#define pgm_read_word(a)   (*(const uint16_t*)(a))
+#define pgm_read_dword(a)  (*(const uint32_t*)(a))
+#define memcpy_P           memcpy
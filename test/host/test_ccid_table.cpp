@@ -0,0 +1,32 @@
+// Ccid::lookup() (sorted PROGMEM table) must resolve every 11-bit CC-ID exactly like the
+// switch/== chains it replaced (ref/ccid_switch.h): track, priority and the isXxx helpers.
+#include "host.h"
+
+namespace ref {
+#include "ref/ccid_switch.h"
+}
+#include "CCIDMap.h"
+
+int main(){
+  unsigned mismatches = 0;
+  for(uint16_t id = 0; id < 2048; id++){
+    uint8_t refPrio;
+    const int refClass = ref::classifyCcid(id, refPrio);
+    const Ccid::Info in = Ccid::lookup(id);
+    const bool same = ref::trackForCcid(id)     == in.track
+                   && refClass                  == in.prio()
+                   && refPrio                   == in.prio()
+                   && ref::isSeatbeltCCID(id)   == isSeatbeltCCID(id)
+                   && ref::isLowFuelCCID(id)    == isLowFuelCCID(id)
+                   && ref::isBatteryLowCCID(id) == isBatteryLowCCID(id)
+                   && ref::isLowBatteryCCID(id) == isLowBatteryCCID(id);
+    if(!same){
+      printf("CC-ID %u: ref track %u prio %u, table track %u prio %u\n",
+             id, ref::trackForCcid(id), refPrio, in.track, in.prio());
+      mismatches++;
+    }
+  }
+  CHECK(mismatches == 0);
+  printf("test_ccid_table: ids 0..2047, %u rows, %u mismatches\n", Ccid::count(), mismatches);
+  return HostTest::failures != 0;
+}
@@ -0,0 +1,153 @@
+// CanBus::isDuplicate() (one slot per subscribed ID) against the shared 10-entry ring it
+// replaced (ref/dedup_ring.h), over a synthetic E60 stream.
+//  - light load (< 10 frames per window, no A-B-A payloads): decisions must be identical
+//  - full load, lockstep: every disagreement must be one of the two known ring artefacts:
+//      evicted  ring lost the matching record to other IDs' traffic and let a duplicate through
+//      aba      ring matched an older payload of the same ID (A, B, A inside the window)
+// Also times both over the full stream (host ns/frame, relative numbers only).
+#include "host.h"
+#include "mcp_can.h"
+#include <vector>
+#include <chrono>
+#define private public
+#include "CanBus.h"
+#undef private
+#include "ref/dedup_ring.h"
+
+struct Frame { uint16_t id; uint8_t len; uint8_t d[8]; uint32_t t; };
+
+static uint32_t s_rng = 12345;
+static uint32_t rnd(uint32_t n){ s_rng = s_rng * 1103515245u + 12345u; return (s_rng >> 16) % n; }
+
+// One cyclic E60 sender: period, DLC, and how its payload evolves frame to frame
+struct Source {
+  uint16_t id; uint16_t periodMs; uint8_t len;
+  enum Kind : uint8_t { Alive, Steady, Toggle, Rotate, Burst } kind;
+  uint32_t next; uint8_t d[8]; uint8_t n;
+};
+
+static void evolve(Source& s){
+  s.n++;
+  switch(s.kind){
+    case Source::Alive:  s.d[s.len - 1] = (uint8_t)(s.d[s.len - 1] + 1); break;   // alive counter: never repeats
+    case Source::Steady: if(rnd(20) == 0) s.d[0]++; break;                          // slow drift
+    case Source::Toggle: if(rnd(10) == 0) s.d[1] ^= 0x01; break;                    // door bit, may flip straight back
+    case Source::Rotate: s.d[0] = (uint8_t)(14 + s.n % 3); break;                   // CC-ID list cycled by KOMBI
+    case Source::Burst:  if(s.n % 8 == 0) s.d[2] = (uint8_t)(rnd(4) + 1); break;    // key fob press repeats
+  }
+}
+
+// full: every subscribed ID at E60 rates; light: three slow IDs, no A-B-A payloads
+static std::vector<Frame> makeStream(bool full, uint32_t durationMs){
+  std::vector<Source> src;
+  if(full){
+    src = {
+      { ID_KL15,       100, 5, Source::Alive  }, { ID_HANDBRAKE,  100, 8, Source::Steady },
+      { ID_DOORS2,     100, 7, Source::Toggle }, { ID_CCID,       100, 8, Source::Rotate },
+      { ID_KEYBTN,      40, 4, Source::Burst  }, { ID_BUTTON,     200, 8, Source::Steady },
+      { ID_AIRBAG,     200, 8, Source::Alive  }, { ID_BATT_CHECK, 500, 8, Source::Steady },
+    };
+  } else {
+    src = {
+      { ID_HANDBRAKE,  200, 8, Source::Steady }, { ID_BUTTON, 200, 8, Source::Steady },
+      { ID_BATT_CHECK, 500, 8, Source::Steady },
+    };
+  }
+  for(size_t i=0;i<src.size();i++){ src[i].next = (uint32_t)(7 * i); memset(src[i].d, 0, 8); src[i].n = 0; }
+
+  std::vector<Frame> out;
+  for(;;){
+    Source* s = &src[0];
+    for(auto& c : src) if(c.next < s->next) s = &c;
+    if(s->next >= durationMs) break;
+    Frame f; f.id = s->id; f.len = s->len; memcpy(f.d, s->d, 8); f.t = s->next;
+    out.push_back(f);
+    if(rnd(20) == 0){ f.t += 1 + rnd(3); out.push_back(f); }   // same frame again (RXB0/RXB1 rollover, retransmit)
+    evolve(*s);
+    s->next += s->periodMs + rnd(5);
+  }
+  return out;
+}
+
+struct Tally { uint32_t frames, same, evicted, aba, unexplained, oldDup, newDup; };
+
+// Independent runs: each structure records what it accepted itself, as on the target.
+static Tally compareFree(const std::vector<Frame>& stream){
+  CanBus bus(10);
+  DedupRing ring;
+  Tally k = {};
+  for(const Frame& f : stream){
+    const bool o = !ring.accept(f.id, f.len, f.d, f.t);
+    const bool n = bus.isDuplicate(f.id, f.len, f.d, f.t);
+    k.frames++; k.oldDup += o; k.newDup += n; k.same += (o == n);
+  }
+  return k;
+}
+
+// Lockstep: the ring records exactly the frames the slots accepted, so one disagreement cannot
+// cascade and each one can be attributed to a ring artefact from the shared accepted log.
+static Tally compareLockstep(const std::vector<Frame>& stream){
+  CanBus bus(10);
+  DedupRing ring;
+  std::vector<Frame> accepted;
+  Tally k = {};
+  for(const Frame& f : stream){
+    const bool o = ring.isDuplicate(f.id, f.len, f.d, f.t);
+    const bool n = bus.isDuplicate(f.id, f.len, f.d, f.t);
+    k.frames++; k.oldDup += o; k.newDup += n;
+    if(o != n){
+      bool anyMatch = false, newestMatches = false, newestSeen = false;
+      for(size_t i = accepted.size(); i-- > 0;){
+        const Frame& r = accepted[i];
+        if(f.t - r.t > ring._dedupWindowMs) break;
+        if(r.id != f.id) continue;
+        const bool m = r.len == f.len && !memcmp(r.d, f.d, f.len);
+        if(!newestSeen){ newestSeen = true; newestMatches = m; }
+        anyMatch |= m;
+      }
+      if(n && newestMatches)                   k.evicted++;
+      else if(o && anyMatch && !newestMatches) k.aba++;
+      else                                     k.unexplained++;
+    } else k.same++;
+    if(!n){ ring.pushHistory(f.id, f.len, f.d, f.t); accepted.push_back(f); }
+  }
+  return k;
+}
+
+template<class F> static double nsPerFrame(const std::vector<Frame>& stream, int reps, F&& fn){
+  const auto t0 = std::chrono::steady_clock::now();
+  uint32_t sink = 0;
+  for(int r=0;r<reps;r++) sink += fn(stream);
+  const auto t1 = std::chrono::steady_clock::now();
+  if(sink == 0xFFFFFFFFu) printf(" ");   // keep the loops
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / ((double)reps * stream.size());
+}
+
+int main(){
+  const std::vector<Frame> light = makeStream(false, 600000);
+  const Tally a = compareFree(light);
+  printf("light: %u frames, %u duplicates (ring %u), identical %u\n", a.frames, a.newDup, a.oldDup, a.same);
+  CHECK(a.same == a.frames);
+  CHECK(a.newDup > 0);
+
+  const std::vector<Frame> full = makeStream(true, 600000);
+  const Tally b = compareLockstep(full);
+  printf("full:  %u frames, %u duplicates (ring %u), identical %u, evicted %u, aba %u, unexplained %u\n",
+         b.frames, b.newDup, b.oldDup, b.same, b.evicted, b.aba, b.unexplained);
+  CHECK(b.unexplained == 0);
+  CHECK(b.evicted > 0);          // the load the slots were introduced for
+
+  const double tRing = nsPerFrame(full, 20, [](const std::vector<Frame>& s){
+    DedupRing ring; uint32_t n = 0;
+    for(const Frame& f : s) n += ring.accept(f.id, f.len, f.d, f.t);
+    return n;
+  });
+  const double tSlot = nsPerFrame(full, 20, [](const std::vector<Frame>& s){
+    CanBus bus(10); uint32_t n = 0;
+    for(const Frame& f : s) n += !bus.isDuplicate(f.id, f.len, f.d, f.t);
+    return n;
+  });
+  printf("host time per frame: ring %.1f ns, slots %.1f ns\n", tRing, tSlot);
+  printf("test_dedup: %s\n", HostTest::failures ? "FAIL" : "ok");
+  return HostTest::failures != 0;
+}
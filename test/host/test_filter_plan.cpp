@@ -0,0 +1,91 @@
+// The compile-time MCP2515 acceptance plan (CanFilterPlan.h) as the chip sees it: CanBus::begin()
+// runs against the register fake, the six filters and two masks are read back, and acceptance is
+// evaluated per the datasheet (standard frames, EID bits against data bytes 0/1).
+//  - every CanIds slot is accepted for any payload, CC-ID and KEYBTN in RXB0
+//  - over all 2048 standard IDs exactly COUNT + UNWANTED_PASSING pass, whatever the payload
+//  - a sample of busy E60 IDs nobody subscribes to is rejected
+#include "mcp2515_fake.h"
+#include "CanBus.h"
+#include "CanFilterPlan.h"
+#include "BMW_E60_CAN_API.h"
+
+static FakeMcp2515 s_mcp;
+
+// Filter/mask register base (SIDH) by index, RXF3 starts the second bank
+static uint8_t filtReg(uint8_t f){ return (uint8_t)(f < 3 ? MCP_RXF0SIDH + 4 * f : MCP_RXF3SIDH + 4 * (f - 3)); }
+static uint8_t maskReg(uint8_t m){ return (uint8_t)(MCP_RXM0SIDH + 4 * m); }
+
+// A standard frame hits filter f under mask m when every masked SID bit matches and, for the
+// EID bits, data bytes 0/1 match EID8/EID0. Filters with EXIDE set never match standard frames.
+static bool hitReg(uint16_t id, const uint8_t* d, uint8_t m, uint8_t f){
+  const uint8_t* M = &s_mcp.reg[maskReg(m)];
+  const uint8_t* F = &s_mcp.reg[filtReg(f)];
+  if(F[1] & MCP_TXB_EXIDE_M) return false;
+  const uint16_t msid = (uint16_t)((M[0] << 3) | (M[1] >> 5));
+  const uint16_t fsid = (uint16_t)((F[0] << 3) | (F[1] >> 5));
+  return ((id ^ fsid) & msid) == 0 && ((d[0] ^ F[2]) & M[2]) == 0 && ((d[1] ^ F[3]) & M[3]) == 0;
+}
+
+// 0 = RXB0, 1 = RXB1, -1 = rejected (RXB0 wins when both match)
+static int accept(uint16_t id, const uint8_t* d){
+  if(hitReg(id, d, 0, 0) || hitReg(id, d, 0, 1)) return 0;
+  for(uint8_t f=2;f<6;f++) if(hitReg(id, d, 1, f)) return 1;
+  return -1;
+}
+
+static uint32_t s_rng = 4242;
+static uint8_t rnd8(){ s_rng = s_rng * 1103515245u + 12345u; return (uint8_t)(s_rng >> 16); }
+
+int main(){
+  HostSpi::device = &s_mcp;
+  CanBus bus;
+  CHECK(bus.begin());
+  // Both buffers must actually filter (RXM bits 00), not receive everything
+  CHECK((s_mcp.reg[MCP_RXB0CTRL] & 0x60) == 0);
+  CHECK((s_mcp.reg[MCP_RXB1CTRL] & 0x60) == 0);
+
+  static const uint8_t kFixed[][2] = { {0x00,0x00}, {0xFF,0xFF}, {0xA5,0x5A} };
+  uint8_t d[2];
+
+  uint16_t misses = 0;
+  for(uint8_t i=0;i<CanIds::COUNT;i++){
+    const uint16_t id = CanIds::idAt(i);
+    const int want = CanFilterPlan::isCritical(id) ? 0 : -2;
+    for(uint16_t k=0;k<3+64;k++){
+      if(k < 3){ d[0] = kFixed[k][0]; d[1] = kFixed[k][1]; } else { d[0] = rnd8(); d[1] = rnd8(); }
+      const int got = accept(id, d);
+      if(got < 0 || (want == 0 && got != 0)){
+        if(misses++ < 8) printf("  id 0x%03X data %02X %02X -> %d\n", id, d[0], d[1], got);
+      }
+    }
+  }
+  CHECK(misses == 0);
+
+  uint16_t passing = 0, unstable = 0;
+  for(uint16_t id=0;id<=CanFilterPlan::FULL_MASK;id++){
+    d[0] = d[1] = 0;
+    const bool p = accept(id, d) >= 0;
+    passing += p;
+    for(uint8_t k=0;k<8;k++){ d[0] = rnd8(); d[1] = rnd8(); unstable += (accept(id, d) >= 0) != p; }
+  }
+  CHECK(passing == CanIds::COUNT + CanFilterPlan::UNWANTED_PASSING);
+  CHECK(unstable == 0);
+
+  // Fast broadcast traffic (10..100 ms) the unit never decodes; any of these passing costs an
+  // ISR per frame. Slow IDs inside UNWANTED_PASSING (e.g. 0x336 DSC) are tolerated by the plan.
+  static const uint16_t kReject[] = {
+    BMW_E60_Torque, BMW_E60_RPM_Throttle, BMW_E60_wheel_speeds, BMW_E60_ABS_Alive_Signal,
+    BMW_E60_SteeringWheelSensor, BMW_E60_SteeringWheelSensor_2, BMW_E60_AirBag_Alive_Signal,
+    BMW_E60_Speed, BMW_E60_Brake, BMW_E60_Engine_Temp, BMW_E60_PDC_Sensordata,
+  };
+  uint8_t leaked = 0;
+  for(uint16_t id : kReject){
+    d[0] = d[1] = 0;
+    if(accept(id, d) >= 0){ leaked++; printf("  unsubscribed 0x%03X passes\n", id); }
+  }
+  CHECK(leaked == 0);
+
+  printf("test_filter_plan: %u IDs pass (%u subscribed + %u unwanted), %s\n", passing,
+         (unsigned)CanIds::COUNT, (unsigned)CanFilterPlan::UNWANTED_PASSING, HostTest::failures ? "FAILED" : "ok");
+  return HostTest::failures != 0;
+}
@@ -0,0 +1,78 @@
+// KOMBI sweep through the timed TX queue, against a scripted MCP2515 on the fake clock.
+//  - tickSweep()/tickTx() never block: the clock does not move inside a call, delay() is never hit
+//  - every sweep step is a two-frame 0x6F1 burst, the copy leaving exactly BURST_GAP_MS later;
+//    bursts never interleave and land on the same milliseconds as the old blocking sweep
+//  - with every TX buffer held busy tickTx() returns at once and the frames leave on release
+#include "mcp2515_fake.h"
+#define private public
+#include "CanBus.h"
+#undef private
+
+static FakeMcp2515 s_mcp;
+static uint32_t s_longestCallUs = 0;
+
+// One main-loop pass; any time spent inside the calls shows up on the fake clock
+static void loopOnce(CanBus& bus){
+  const uint32_t before = HostClock::us;
+  bus.tickSweep();
+  bus.tickTx();
+  if(HostClock::us - before > s_longestCallUs) s_longestCallUs = HostClock::us - before;
+}
+static void runFor(CanBus& bus, uint32_t ms){
+  for(uint32_t i=0;i<ms;i++){ loopOnce(bus); HostClock::advanceMs(1); }
+}
+
+static void sweepTiming(){
+  CanBus bus(10);
+  bus.setSweepTiming(28, 35, 1000, 4000);
+  s_mcp.sent.clear();
+
+  bus.updateKL15_fromB0(0x04);                  // KL15 on: arm
+  const uint32_t t0 = millis();
+  runFor(bus, 6000);
+
+  // spdMax, tacMax, spdStop, tacStop: each one frame + its copy BURST_GAP_MS later, bursts back to
+  // back as the blocking sendBurst() (frame, delay(30), frame, delay(30)) produced them
+  static const uint16_t kBaselineMs[8] = { 4028, 4058, 4088, 4118, 5116, 5146, 5176, 5206 };
+  static const uint8_t  kNeedle[4]     = { 0x20, 0x21, 0x20, 0x21 };   // 0x30 0x20 speed, 0x30 0x21 rpm
+  CHECK(s_mcp.sent.size() == 8);
+  for(size_t i=0;i<s_mcp.sent.size() && i<8;i++){
+    const FakeMcp2515::Sent& s = s_mcp.sent[i];
+    CHECK(s.id == 0x6F1);
+    CHECK(s.t - t0 == kBaselineMs[i]);
+    CHECK(s.d[3] == kNeedle[i / 2]);
+    if(i & 1) CHECK(s.len == s_mcp.sent[i-1].len && !memcmp(s.d, s_mcp.sent[i-1].d, s.len));
+  }
+  for(size_t i=0;i<s_mcp.sent.size();i++)
+    printf("  t=%5u ms  %03X  %02X %02X %02X %02X %02X %02X %02X\n", (unsigned)(s_mcp.sent[i].t - t0), s_mcp.sent[i].id,
+           s_mcp.sent[i].d[0], s_mcp.sent[i].d[1], s_mcp.sent[i].d[2], s_mcp.sent[i].d[3],
+           s_mcp.sent[i].d[4], s_mcp.sent[i].d[5], s_mcp.sent[i].d[6]);
+}
+
+static void busyBuffers(){
+  CanBus bus(10);
+  s_mcp.sent.clear();
+  s_mcp.hold = true;                            // nothing leaves the controller
+  const uint8_t d[2] = { 1, 2 };
+  for(uint8_t i=0;i<CanBus::TX_Q_CAP;i++) CHECK(bus.scheduleTx(0x6F1, 2, d, 0));
+  CHECK(!bus.scheduleTx(0x6F1, 2, d, 0));       // queue full: refused, not overwritten
+  runFor(bus, 50);
+  CHECK(s_mcp.sent.empty());
+  CHECK(bus._txCount == CanBus::TX_Q_CAP - 3);  // three in TX buffers, the rest waiting in the queue
+  s_mcp.release();
+  runFor(bus, 2);
+  s_mcp.release();
+  CHECK(s_mcp.sent.size() == CanBus::TX_Q_CAP);
+  CHECK(bus._txCount == 0);
+}
+
+int main(){
+  HostSpi::device = &s_mcp;
+  sweepTiming();
+  busyBuffers();
+  CHECK(HostClock::delayCalls == 0);
+  CHECK(s_longestCallUs == 0);
+  printf("test_sweep: longest tickSweep()+tickTx() %u us, delay() calls %u, %s\n",
+         (unsigned)s_longestCallUs, (unsigned)HostClock::delayCalls, HostTest::failures ? "FAIL" : "ok");
+  return HostTest::failures != 0;
+}
@@ -0,0 +1,79 @@
+// TimerTxUart (DF_LINK_TIMER_TX / the HWSERIAL debug channel) against an emulated Timer2:
+// every compare match drives OC2B from COM2B1:0, then runs the ISR if OCIE2B is set.
+//  - 9600 Bd at 16 MHz: 208 counts per bit (OCR2A 207)
+//  - a DF frame comes out as 10 UART characters, 8N1, LSB first, line at mark in between
+//  - a full ring never waits: single bytes drop (counted), a buffer goes in whole or not at all
+#include "host.h"
+#include "DfLink.h"
+#include <vector>
+
+static uint8_t s_line = 1;
+static std::vector<uint8_t> s_wire;          // OC2B level after each compare match
+
+static void compareMatch(){
+  const uint8_t com = (uint8_t)((TCCR2A >> COM2B0) & 3);
+  if(com == 3) s_line = 1; else if(com == 2) s_line = 0;
+  s_wire.push_back(s_line);
+  if(TIMSK2 & _BV(OCIE2B)) TimerTxUart::isrBit();
+}
+static void runBits(uint32_t n){ while(n--) compareMatch(); }
+static void drain(){ uint32_t guard = 0; while((TIMSK2 & _BV(OCIE2B)) && guard++ < 10000) compareMatch(); }
+
+// 8N1 decode of s_wire; false on a framing error
+static bool decode(std::vector<uint8_t>& out){
+  size_t i = 0;
+  while(i < s_wire.size()){
+    if(s_wire[i]){ i++; continue; }
+    if(i + 10 > s_wire.size()) return false;
+    uint8_t b = 0;
+    for(uint8_t k=0;k<8;k++) b |= (uint8_t)(s_wire[i + 1 + k] << k);
+    if(!s_wire[i + 9]) return false;           // stop bit
+    out.push_back(b);
+    i += 10;
+  }
+  return true;
+}
+
+int main(){
+  TimerTxUart tx;
+  tx.begin(9600);
+  CHECK(OCR2A == 207);
+  CHECK(tx.availableForWrite() == 31);
+
+  // One DF frame (PLAY track 7), as DFPMini queues it
+  const uint8_t frame[10] = { 0x7E, 0xFF, 0x06, 0x12, 0x00, 0x00, 0x07, 0xFE, 0xE2, 0xEF };
+  CHECK(tx.write(frame, sizeof(frame)) == sizeof(frame));
+  drain();
+  std::vector<uint8_t> got;
+  CHECK(decode(got));
+  CHECK(got.size() == sizeof(frame) && !memcmp(got.data(), frame, sizeof(frame)));
+  CHECK(s_line == 1);
+  const size_t bitsPerFrame = s_wire.size();
+
+  // Full ring, ISR stalled: single bytes drop, a buffer is refused whole
+  s_wire.clear();
+  tx.begin(9600);
+  TIMSK2 = 0;                                  // hold the ISR off: nothing leaves
+  uint8_t accepted = 0;
+  for(uint8_t i=0;i<40;i++){ accepted += (uint8_t)tx.write((uint8_t)('a' + (i % 26))); TIMSK2 = 0; }
+  CHECK(accepted == 31);
+  CHECK(tx.dropped() == 9);
+  CHECK(tx.write(frame, sizeof(frame)) == 0);
+  CHECK(tx.dropped() == 19);
+  CHECK(tx.availableForWrite() == 0);
+
+  // Room reappears as bytes are shifted out; then the frame fits
+  TIMSK2 |= _BV(OCIE2B);
+  runBits(10 * 10 + 1);
+  CHECK(tx.availableForWrite() >= 10);
+  CHECK(tx.write(frame, sizeof(frame)) == sizeof(frame));
+  drain();
+  got.clear();
+  CHECK(decode(got));
+  CHECK(got.size() == 31 + sizeof(frame));
+  if(got.size() == 31 + sizeof(frame)) CHECK(!memcmp(got.data() + 31, frame, sizeof(frame)));
+
+  printf("test_timer_tx: DF frame %u bit times (%u us at 9600 Bd), %u dropped, %s\n",
+         (unsigned)bitsPerFrame, (unsigned)(bitsPerFrame * 104), (unsigned)tx.dropped(), HostTest::failures ? "FAIL" : "ok");
+  return HostTest::failures != 0;
+}